@@ -0,0 +1,108 @@
+/*
+flat_hash_map vs std::unordered_map, C++14 and later
+
+Build:
+  c++ -O2 -std=c++14 bench/flat_hash_map_bench.cpp -o flat_hash_map_bench
+
+Usage:
+  flat_hash_map_bench [key-count]
+*/
+
+#define SIPHASH_IMPLEMENTATION
+#define FNV_IMPLEMENTATION
+#define GEN_SEED_IMPLEMENTATION
+#include "../flat_hash_map.hpp"
+
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../splitmix.hpp"
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+volatile size_t g_sink = 0;
+
+template <class Fn>
+double ns_per_op(size_t ops, Fn fn) {
+    const auto start = bench_clock::now();
+    fn();
+    const auto stop = bench_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+}
+
+template <class Map, class Key>
+void run(const char* name, const std::vector<Key>& keys, const std::vector<Key>& misses) {
+    Map map;
+    const double insert = ns_per_op(keys.size(), [&] {
+        for (size_t i = 0; i < keys.size(); i++)
+            map[keys[i]] = i;
+    });
+
+    const double hit = ns_per_op(keys.size(), [&] {
+        size_t sum = 0;
+        for (const auto& k : keys)
+            sum += map.find(k)->second;
+        g_sink = g_sink + sum;
+    });
+
+    const double miss = ns_per_op(misses.size(), [&] {
+        size_t found = 0;
+        for (const auto& k : misses)
+            found += map.find(k) != map.end();
+        g_sink = g_sink + found;
+    });
+
+    const double iterate = ns_per_op(map.size(), [&] {
+        size_t sum = 0;
+        for (const auto& kv : map)
+            sum += kv.second;
+        g_sink = g_sink + sum;
+    });
+
+    const double erase = ns_per_op(keys.size(), [&] {
+        for (const auto& k : keys)
+            map.erase(k);
+    });
+
+    std::printf("%-40s %8.2f %8.2f %8.2f %8.2f %8.2f\n",
+        name, insert, hit, miss, iterate, erase);
+}
+
+template <class Key, class Make>
+void run_all(const char* title, size_t count, Make make) {
+    splitmix gen(42);
+    std::vector<Key> keys, misses;
+    for (size_t i = 0; i < count; i++) keys.push_back(make(gen()));
+    for (size_t i = 0; i < count; i++) misses.push_back(make(gen()));
+
+    std::printf("\n%s, %zu keys, ns/op\n", title, count);
+    std::printf("%-40s %8s %8s %8s %8s %8s\n", "container",
+        "insert", "hit", "miss", "iterate", "erase");
+    run<std::unordered_map<Key, size_t>>("std::unordered_map (std::hash)", keys, misses);
+    run<std::unordered_map<Key, size_t, siphash_hasher<Key>>>("std::unordered_map (siphash_hasher)", keys, misses);
+    run<flat_hash_map<Key, size_t>>("flat_hash_map (siphash_hasher)", keys, misses);
+    run<flat_hash_map<Key, size_t, fnv1a_hasher<Key>>>("flat_hash_map (fnv1a_hasher)", keys, misses);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if (count == 0) {
+        std::fprintf(stderr, "usage: %s [key-count]\n", argv[0]);
+        return 2;
+    }
+
+    run_all<uint64_t>("uint64_t keys", count,
+        [](uint64_t v) { return v; });
+    run_all<std::string>("std::string keys (16-24 chars)", count,
+        [](uint64_t v) { return "key:" + std::to_string(v); });
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+inplace_spsc_queue / inplace_mpmc_queue throughput, C++14 and later
+
+Build:
+  c++ -O2 -std=c++14 -pthread bench/inplace_queue_bench.cpp -o inplace_queue_bench
+
+Usage:
+  inplace_queue_bench [items-per-producer] [threads]
+*/
+
+#include "../inplace_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+constexpr size_t batch_size = 32;
+constexpr size_t queue_size = 4096;
+
+// sum of pushed values is checked to catch lost or duplicated items
+template <class Queue>
+bool run(const char* name, size_t producers, size_t consumers, size_t items, bool batch) {
+    static Queue queue;
+    std::atomic<size_t> popped {0};
+    std::atomic<unsigned long long> sum {0};
+    std::atomic<bool> start {false};
+    const size_t total = producers * items;
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            size_t buffer[batch_size];
+            for (size_t i = 0; i < items;) {
+                size_t pushed;
+                if (batch) {
+                    const size_t count = std::min(batch_size, items - i);
+                    for (size_t k = 0; k < count; k++) buffer[k] = p * items + i + k + 1;
+                    pushed = queue.try_push_n(buffer, count);
+                } else {
+                    pushed = queue.try_push(p * items + i + 1) ? 1 : 0;
+                }
+                if (pushed == 0) std::this_thread::yield();
+                i += pushed;
+            }
+        });
+    }
+    for (size_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            size_t buffer[batch_size];
+            unsigned long long local = 0;
+            while (popped.load(std::memory_order_relaxed) < total) {
+                size_t count = 0;
+                if (batch) count = queue.try_pop_n(buffer, batch_size);
+                else count = queue.try_pop(buffer[0]) ? 1 : 0;
+                if (count == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t k = 0; k < count; k++) local += buffer[k];
+                popped.fetch_add(count, std::memory_order_relaxed);
+            }
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+
+    const auto begin = bench_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    const auto end = bench_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    const unsigned long long expected = static_cast<unsigned long long>(total) * (total + 1) / 2;
+    const bool ok = sum.load() == expected;
+    char label[32];
+    std::snprintf(label, sizeof label, "%zuP/%zuC", producers, consumers);
+    std::printf("%-20s %-8s %-6s %10.2f Mitems/s %s\n", name, label,
+        batch ? "batch" : "single", total / seconds / 1e6, ok ? "" : "CHECKSUM MISMATCH");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                    : std::max(2u, std::thread::hardware_concurrency());
+    if (items == 0 || threads < 2) {
+        std::fprintf(stderr, "usage: %s [items-per-producer] [threads >= 2]\n", argv[0]);
+        return 2;
+    }
+
+    using spsc = inplace_spsc_queue<size_t, queue_size>;
+    using mpmc = inplace_mpmc_queue<size_t, queue_size>;
+
+    bool ok = true;
+    ok &= run<spsc>("inplace_spsc_queue", 1, 1, items, false);
+    ok &= run<spsc>("inplace_spsc_queue", 1, 1, items, true);
+    ok &= run<mpmc>("inplace_mpmc_queue", 1, 1, items, false);
+    ok &= run<mpmc>("inplace_mpmc_queue", 1, 1, items, true);
+
+    const size_t half = threads / 2;
+    ok &= run<mpmc>("inplace_mpmc_queue", half, threads - half, items / half, false);
+    ok &= run<mpmc>("inplace_mpmc_queue", half, threads - half, items / half, true);
+    return ok ? 0 : 1;
+}
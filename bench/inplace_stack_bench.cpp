@@ -0,0 +1,287 @@
+/*
+inplace_stack vs std::stack<T, std::vector<T>> and std::vector, C++14 and later
+
+Build:
+  c++ -O2 -std=c++14 bench/inplace_stack_bench.cpp -o inplace_stack_bench
+
+Usage:
+  inplace_stack_bench [operations]
+
+Columns are ns/op, heap allocations/op (counting operator new) and
+cache misses/op (Linux perf_event, '-' if not permitted, see
+/proc/sys/kernel/perf_event_paranoid).
+
+Binary size impact, build with only one container family and compare:
+  c++ -O2 -std=c++14 -DBENCH_ONLY=1 bench/inplace_stack_bench.cpp -o b_inplace && size b_inplace
+  c++ -O2 -std=c++14 -DBENCH_ONLY=2 bench/inplace_stack_bench.cpp -o b_std && size b_std
+*/
+
+#include "../inplace_stack.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stack>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef BENCH_ONLY
+#define BENCH_ONLY 0 // 0 all, 1 inplace_stack, 2 std containers
+#endif
+
+/* Counting operator new, replaces global one */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc/free pair is intended
+#endif
+
+static std::atomic<size_t> g_allocations {0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+volatile size_t g_sink = 0;
+
+class cache_miss_counter {
+public:
+    cache_miss_counter() {
+#ifdef __linux__
+        perf_event_attr attr {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof attr;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~cache_miss_counter() {
+#ifdef __linux__
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    bool available() const { return m_fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (m_fd < 0) return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop() {
+        long long count = 0;
+#ifdef __linux__
+        if (m_fd < 0) return -1;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_fd, &count, sizeof count) != sizeof count) return -1;
+#endif
+        return count;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+cache_miss_counter g_misses;
+
+template <class Fn>
+void measure(const char* container, const char* op, size_t ops, Fn fn) {
+    const size_t allocs_before = g_allocations.load(std::memory_order_relaxed);
+    g_misses.start();
+    const auto start = bench_clock::now();
+    fn();
+    const auto stop = bench_clock::now();
+    const long long misses = g_misses.stop();
+    const size_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+    const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+    char miss_text[32] = "-";
+    if (misses >= 0)
+        std::snprintf(miss_text, sizeof miss_text, "%.3f", double(misses) / ops);
+    std::printf("%-44s %-22s %10.2f %10.3f %10s\n", container, op, ns, double(allocs) / ops, miss_text);
+}
+
+/* Uniform interface over containers */
+
+template <class S> struct ops;
+
+template <class T, size_t N>
+struct ops<impl::Inplace_stack_is_cexpr<T, N>> {
+    using S = impl::Inplace_stack_is_cexpr<T, N>;
+    static void push(S& s, const T& v) { s.push(v); }
+    static void emplace(S& s, const T& v) { s.emplace(v); }
+    static void pop(S& s) { s.pop(); }
+    static const T& top(const S& s) { return s.top(); }
+};
+template <class T, size_t N>
+struct ops<impl::Inplace_stack_no_cexpr<T, N>> {
+    using S = impl::Inplace_stack_no_cexpr<T, N>;
+    static void push(S& s, const T& v) { s.push(v); }
+    static void emplace(S& s, const T& v) { s.emplace(v); }
+    static void pop(S& s) { s.pop(); }
+    static const T& top(const S& s) { return s.top(); }
+};
+template <class T>
+struct ops<std::stack<T, std::vector<T>>> {
+    using S = std::stack<T, std::vector<T>>;
+    static void push(S& s, const T& v) { s.push(v); }
+    static void emplace(S& s, const T& v) { s.emplace(v); }
+    static void pop(S& s) { s.pop(); }
+    static const T& top(const S& s) { return s.top(); }
+};
+template <class T>
+struct ops<std::vector<T>> {
+    using S = std::vector<T>;
+    static void push(S& s, const T& v) { s.push_back(v); }
+    static void emplace(S& s, const T& v) { s.emplace_back(v); }
+    static void pop(S& s) { s.pop_back(); }
+    static const T& top(const S& s) { return s.back(); }
+};
+
+template <class T> T make_value(size_t i);
+template <> size_t make_value<size_t>(size_t i) { return i; }
+template <> std::string make_value<std::string>(size_t i) {
+    return std::string(24 + i % 8, char('a' + i % 26)); // longer than SSO, allocates
+}
+
+template <class T> size_t weight(const T& v);
+template <> size_t weight<size_t>(const size_t& v) { return v; }
+template <> size_t weight<std::string>(const std::string& v) { return v.size(); }
+
+// push/pop/emplace/top cycles with depth up to 'depth'
+template <class S, class T>
+void run_throughput(const char* name, size_t depth, size_t total) {
+    using O = ops<S>;
+    std::vector<T> values;
+    for (size_t i = 0; i < depth; i++) values.push_back(make_value<T>(i));
+    const size_t rounds = std::max<size_t>(1, total / depth);
+
+    S s;
+    measure(name, "push+pop", rounds * depth, [&] {
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < depth; i++) O::push(s, values[i]);
+            for (size_t i = 0; i < depth; i++) O::pop(s);
+        }
+    });
+    measure(name, "emplace+top+pop", rounds * depth, [&] {
+        size_t sum = 0;
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < depth; i++) O::emplace(s, values[i]);
+            for (size_t i = 0; i < depth; i++) {
+                sum += weight(O::top(s));
+                O::pop(s);
+            }
+        }
+        g_sink = g_sink + sum;
+    });
+}
+
+// copy, move and swap with 'size' live elements
+template <class S, class T>
+void run_copy_move(const char* name, size_t size, size_t total) {
+    using O = ops<S>;
+    S a, b;
+    for (size_t i = 0; i < size; i++) O::push(a, make_value<T>(i));
+    const size_t rounds = std::max<size_t>(1, total / 64);
+
+    char op[32];
+    std::snprintf(op, sizeof op, "copy size=%zu", size);
+    measure(name, op, rounds, [&] {
+        for (size_t r = 0; r < rounds; r++) {
+            S c(a);
+            g_sink = g_sink + c.size();
+        }
+    });
+    std::snprintf(op, sizeof op, "move size=%zu", size);
+    measure(name, op, rounds, [&] {
+        for (size_t r = 0; r < rounds; r++) {
+            S c(std::move(a));
+            a = std::move(c);
+        }
+        g_sink = g_sink + a.size();
+    });
+    std::snprintf(op, sizeof op, "swap size=%zu", size);
+    measure(name, op, rounds, [&] {
+        using std::swap;
+        for (size_t r = 0; r < rounds; r++)
+            swap(a, b);
+        g_sink = g_sink + a.size();
+    });
+}
+
+template <class T, size_t N>
+void run_family(const char* type_name, size_t total) {
+    using inplace = inplace_stack<T, N>;
+    using stack   = std::stack<T, std::vector<T>>;
+    using vector  = std::vector<T>;
+
+    char names[3][64];
+    std::snprintf(names[0], sizeof names[0], "inplace_stack<%s, %zu>", type_name, N);
+    std::snprintf(names[1], sizeof names[1], "std::stack<%s, vector>", type_name);
+    std::snprintf(names[2], sizeof names[2], "std::vector<%s>", type_name);
+
+    std::printf("\n%s, N = %zu, sizeof inplace_stack = %zu, sizeof std::vector = %zu\n",
+        type_name, N, sizeof(inplace), sizeof(vector));
+    std::printf("%-44s %-22s %10s %10s %10s\n", "container", "operation", "ns/op", "allocs/op", "misses/op");
+
+    for (size_t depth : {size_t(8), N}) {
+#if BENCH_ONLY != 2
+        run_throughput<inplace, T>(names[0], depth, total);
+#endif
+#if BENCH_ONLY != 1
+        run_throughput<stack, T>(names[1], depth, total);
+        run_throughput<vector, T>(names[2], depth, total);
+#endif
+    }
+    for (size_t size : {size_t(0), size_t(8), N}) {
+#if BENCH_ONLY != 2
+        run_copy_move<inplace, T>(names[0], size, total);
+#endif
+#if BENCH_ONLY != 1
+        run_copy_move<vector, T>(names[2], size, total);
+#endif
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    if (total == 0) {
+        std::fprintf(stderr, "usage: %s [operations]\n", argv[0]);
+        return 2;
+    }
+    if (!g_misses.available())
+        std::printf("cache miss counter is not available\n");
+
+    // size_t selects Inplace_stack_is_cexpr, std::string selects Inplace_stack_no_cexpr
+    run_family<size_t, 64>("size_t", total);
+    run_family<size_t, 4096>("size_t", total);
+    run_family<std::string, 64>("std::string", total / 4);
+    run_family<std::string, 1024>("std::string", total / 4);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+Throughput and statistical smoke test for xorshift.h, xorshift.hpp
+and splitmix.hpp,
+C++11 and later
+
+Build:
+  c++ -O2 -std=c++11 bench/xorshift_bench.cpp -o xorshift_bench
+
+Usage:
+  xorshift_bench [values-per-run]
+
+Exit code is non-zero if any generator fails the smoke test
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+/* xorshift.h twice: state-struct and state-in-static mode */
+
+#define xorshift32        xs_struct_32
+#define xorshift64        xs_struct_64
+#define xorshift64s       xs_struct_64s
+#define xorshift32_state  xs_struct_32_state
+#define xorshift64_state  xs_struct_64_state
+#define xorshift64s_state xs_struct_64s_state
+#define XORSHIFT_IMPLEMENTATION
+#include "../xorshift.h"
+#undef xorshift32
+#undef xorshift64
+#undef xorshift64s
+#undef xorshift32_state
+#undef xorshift64_state
+#undef xorshift64s_state
+#undef XORSHIFT_PRNG_H
+
+#define xorshift32        xs_static_32
+#define xorshift64        xs_static_64
+#define xorshift64s       xs_static_64s
+#define xorshift32_state  xs_static_32_state
+#define xorshift64_state  xs_static_64_state
+#define xorshift64s_state xs_static_64s_state
+#define XORSHIFT_STATIC_STATE
+#include "../xorshift.h"
+#undef xorshift32
+#undef xorshift64
+#undef xorshift64s
+#undef xorshift32_state
+#undef xorshift64_state
+#undef xorshift64s_state
+#undef XORSHIFT_STATIC_STATE
+#undef XORSHIFT_IMPLEMENTATION
+
+#include "../xorshift.hpp"
+#include "../splitmix.hpp"
+
+namespace {
+
+/* Generator adaptors: operator() returns next value, bits is output width */
+
+struct c32_struct {
+    static constexpr unsigned bits = 32;
+    xs_struct_32_state st {UINT32_C(2463534242)};
+    uint64_t operator()() { return xs_struct_32(&st); }
+};
+struct c64_struct {
+    static constexpr unsigned bits = 64;
+    xs_struct_64_state st {UINT64_C(88172645463325252)};
+    uint64_t operator()() { return xs_struct_64(&st); }
+};
+struct c64s_struct {
+    static constexpr unsigned bits = 64;
+    xs_struct_64s_state st {UINT64_C(88172645463325252)};
+    uint64_t operator()() { return xs_struct_64s(&st); }
+};
+
+struct c32_static {
+    static constexpr unsigned bits = 32;
+    c32_static() { xs_static_32_state(UINT32_C(2463534242)); }
+    uint64_t operator()() { return xs_static_32(); }
+};
+struct c64_static {
+    static constexpr unsigned bits = 64;
+    c64_static() { xs_static_64_state(UINT64_C(88172645463325252)); }
+    uint64_t operator()() { return xs_static_64(); }
+};
+struct c64s_static {
+    static constexpr unsigned bits = 64;
+    c64s_static() { xs_static_64s_state(UINT64_C(88172645463325252)); }
+    uint64_t operator()() { return xs_static_64s(); }
+};
+
+template <class Engine, unsigned Bits>
+struct cxx_engine {
+    static constexpr unsigned bits = Bits;
+    Engine eng {};
+    uint64_t operator()() { return eng() - Engine::min(); }
+};
+
+using cxx_xorshift = cxx_engine<xorshift,         64>;
+using cxx_splitmix = cxx_engine<splitmix,         64>;
+using cxx_mt64     = cxx_engine<std::mt19937_64,  64>;
+using cxx_minstd   = cxx_engine<std::minstd_rand, 31>; // [1, 2^31 - 2]
+
+/* Timing */
+
+using bench_clock = std::chrono::steady_clock;
+
+volatile uint64_t g_sink = 0;
+
+template <class Gen>
+double bench_scalar(size_t count) {
+    Gen gen;
+    uint64_t acc = 0;
+    const auto start = bench_clock::now();
+    for (size_t i = 0; i < count; i++)
+        acc += gen();
+    const auto stop = bench_clock::now();
+    g_sink = g_sink + acc;
+    return std::chrono::duration<double, std::nano>(stop - start).count() / count;
+}
+
+template <class Gen>
+double bench_bulk(size_t count) {
+    Gen gen;
+    std::vector<uint64_t> buf(4096);
+    size_t left = count;
+    const auto start = bench_clock::now();
+    while (left > 0) {
+        const size_t n = left < buf.size() ? left : buf.size();
+        std::generate(buf.begin(), buf.begin() + n, std::ref(gen));
+        left -= n;
+    }
+    const auto stop = bench_clock::now();
+    g_sink = g_sink + buf[0] + buf[buf.size() - 1];
+    return std::chrono::duration<double, std::nano>(stop - start).count() / count;
+}
+
+/* Statistical smoke test, each check is z-score with |z| < limit */
+
+constexpr double z_limit = 5.0;
+
+template <class Gen>
+double monobit_z(size_t count) {
+    Gen gen;
+    uint64_t ones = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v = gen();
+        for (unsigned b = 0; b < Gen::bits; b++, v >>= 1)
+            ones += v & 1;
+    }
+    const double n = double(count) * Gen::bits;
+    return (double(ones) - n / 2) / std::sqrt(n / 4);
+}
+
+template <class Gen>
+double runs_z(size_t count) {
+    Gen gen;
+    uint64_t ones = 0, runs = 0;
+    int prev = -1;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v = gen();
+        for (unsigned b = 0; b < Gen::bits; b++, v >>= 1) {
+            const int bit = int(v & 1);
+            ones += bit;
+            if (bit != prev) runs++;
+            prev = bit;
+        }
+    }
+    const double n  = double(count) * Gen::bits;
+    const double n1 = double(ones), n0 = n - n1;
+    const double mean = 2 * n1 * n0 / n + 1;
+    const double var  = (mean - 1) * (mean - 2) / (n - 1);
+    return (double(runs) - mean) / std::sqrt(var);
+}
+
+// Marsaglia: 512 birthdays in a year of 2^24 days, lambda = 2 per round
+template <class Gen>
+double birthday_z(size_t rounds) {
+    constexpr size_t   m = 512;
+    constexpr unsigned k = 24;
+    const double lambda = double(m) * m * m / (4.0 * double(uint64_t(1) << k));
+
+    Gen gen;
+    uint64_t duplicates = 0;
+    std::vector<uint32_t> days(m), spacings(m);
+    for (size_t r = 0; r < rounds; r++) {
+        for (auto& d : days)
+            d = uint32_t(gen() >> (Gen::bits - k));
+        std::sort(days.begin(), days.end());
+        spacings[0] = days[0];
+        for (size_t i = 1; i < m; i++)
+            spacings[i] = days[i] - days[i - 1];
+        std::sort(spacings.begin(), spacings.end());
+        for (size_t i = 1; i < m; i++)
+            duplicates += spacings[i] == spacings[i - 1];
+    }
+    const double mean = lambda * rounds;
+    return (double(duplicates) - mean) / std::sqrt(mean);
+}
+
+bool g_failed = false;
+
+template <class Gen>
+void run(const char* name, size_t count) {
+    const double scalar = bench_scalar<Gen>(count);
+    const double bulk   = bench_bulk<Gen>(count);
+
+    const double zs[3] = {
+        monobit_z<Gen>(count / 64 + 1),
+        runs_z<Gen>(count / 64 + 1),
+        birthday_z<Gen>(200)
+    };
+    bool ok = true;
+    for (double z : zs)
+        ok = ok && std::fabs(z) < z_limit;
+    g_failed = g_failed || !ok;
+
+    std::printf("%-22s %8.3f %10.1f %8.3f %10.1f   %+6.2f %+6.2f %+6.2f  %s\n",
+        name, scalar, 1e3 / scalar, bulk, 1e3 / bulk,
+        zs[0], zs[1], zs[2], ok ? "ok" : "FAIL");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+    if (count == 0) {
+        std::fprintf(stderr, "usage: %s [values-per-run]\n", argv[0]);
+        return 2;
+    }
+
+    std::printf("%-22s %8s %10s %8s %10s   %6s %6s %6s\n", "generator",
+        "ns/val", "Mval/s", "bulk ns", "bulk Mv/s", "z-bit", "z-runs", "z-bday");
+
+    run<c32_struct >("xorshift32  (struct)", count);
+    run<c32_static >("xorshift32  (static)", count);
+    run<c64_struct >("xorshift64  (struct)", count);
+    run<c64_static >("xorshift64  (static)", count);
+    run<c64s_struct>("xorshift64s (struct)", count);
+    run<c64s_static>("xorshift64s (static)", count);
+    run<cxx_xorshift>("xorshift (C++)", count);
+    run<cxx_splitmix>("splitmix (C++)", count);
+    run<cxx_mt64   >("std::mt19937_64", count);
+    run<cxx_minstd >("std::minstd_rand", count);
+
+    return g_failed ? 1 : 0;
+}
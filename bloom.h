@@ -0,0 +1,346 @@
+/* Cache-line blocked Bloom filter in C over fnv1a_64 or siphash_2_4 */
+/*
+Each key sets k bits inside one 64-byte block (512 bits),
+so insert and query touch one cache line:
+  h     = hash(key)              - one fnv1a_64 or siphash_2_4 call,
+                                   fnv1a_64 followed by 64-bit finalizer
+  block = h * nblocks >> 64
+  g     = h * 0x9e3779b97f4a7c15
+  bit i = (g >> 32) + i * ((uint32_t)g | 1), top 9 bits, i = 0..k-1
+
+Serialized format (host byte order, blocks start at 64-byte offset):
+  offset  size  field
+       0     8  magic "SOHBLOOM"
+       8     4  version = 1
+      12     4  k
+      16     4  hash kind
+      20    12  reserved, zero
+      32     8  nblocks
+      40    16  siphash key (low, high)
+      56     8  reserved, zero
+      64   ...  nblocks * 64 bytes of blocks
+bloom_map_file maps file read-only (MAP_SHARED), so one copy in page
+cache is shared between processes, such filter must not be modified
+
+For linking need define in one translation unit:
+  BLOOM_IMPLEMENTATION, SIPHASH_IMPLEMENTATION, FNV_IMPLEMENTATION
+and link with libm (-lm); with strict -std=c99/c11 that translation unit
+needs _POSIX_C_SOURCE 200112L (posix_memalign) defined before first include
+*/
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "hash/siphash.h"
+#include "hash/fnv.h"
+
+#ifndef BLOOM_DEF
+#define BLOOM_DEF
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BLOOM_HASH_FNV1A_64    = 0,
+    BLOOM_HASH_SIPHASH_2_4 = 1
+} bloom_hash_kind;
+
+typedef struct {
+    uint64_t* blocks;  // nblocks * 8 words, 64-byte aligned
+    uint64_t nblocks;
+    uint32_t k;
+    uint32_t hash_kind;
+    siphash_key_t key; // used with BLOOM_HASH_SIPHASH_2_4
+    void* mapping;     // not NULL if loaded by bloom_map_file
+    size_t mapping_size;
+    int owned;         // blocks allocated by bloom_init
+} bloom_t;
+
+// all functions returning int give 0 on success and -1 on error
+
+BLOOM_DEF int  bloom_init(bloom_t* bf, uint64_t expected_keys, double fp_rate,
+    bloom_hash_kind kind, siphash_key_t key);
+BLOOM_DEF void bloom_free(bloom_t* bf);
+BLOOM_DEF void bloom_clear(bloom_t* bf);
+
+BLOOM_DEF uint64_t bloom_hash(const bloom_t* bf, const void* source, size_t count);
+BLOOM_DEF void bloom_insert_hash(bloom_t* bf, uint64_t hash);
+BLOOM_DEF int  bloom_query_hash(const bloom_t* bf, uint64_t hash);
+
+BLOOM_DEF void bloom_insert(bloom_t* bf, const void* source, size_t count);
+BLOOM_DEF int  bloom_query(const bloom_t* bf, const void* source, size_t count);
+
+// keys[i] with length counts[i], result[i] is 1 if key may be in set
+BLOOM_DEF void bloom_insert_batch(bloom_t* bf,
+    const void* const* keys, const size_t* counts, size_t n);
+BLOOM_DEF void bloom_query_batch(const bloom_t* bf,
+    const void* const* keys, const size_t* counts, size_t n, uint8_t* result);
+
+BLOOM_DEF size_t bloom_serialized_size(const bloom_t* bf);
+BLOOM_DEF int bloom_write(const bloom_t* bf, FILE* file);
+BLOOM_DEF int bloom_view(bloom_t* bf, const void* data, size_t size);
+BLOOM_DEF int bloom_map_file(bloom_t* bf, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLOOM_H
+
+#ifdef BLOOM_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#define BLOOM_D_BLOCK_BYTES  64
+#define BLOOM_D_BLOCK_WORDS  8
+#define BLOOM_D_HEADER_BYTES 64
+#define BLOOM_D_VERSION      1
+#define BLOOM_D_BATCH        16
+
+const char bloom_d_magic[8] = {'S', 'O', 'H', 'B', 'L', 'O', 'O', 'M'};
+
+// high half of 64x64 product, same on every target so serialized filters are portable
+uint64_t bloom_d_block_index(uint64_t hash, uint64_t nblocks) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 u128;
+    return (uint64_t)(((u128)hash * nblocks) >> 64);
+#else
+    const uint64_t a_lo = (uint32_t)hash, a_hi = hash >> 32;
+    const uint64_t b_lo = (uint32_t)nblocks, b_hi = nblocks >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+    const uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+    return a_hi * b_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+#endif
+}
+
+void bloom_d_make_mask(uint64_t mask[BLOOM_D_BLOCK_WORDS], uint64_t hash, uint32_t k) {
+    const uint64_t g = hash * UINT64_C(0x9e3779b97f4a7c15);
+    uint32_t a = (uint32_t)(g >> 32);
+    const uint32_t b = (uint32_t)g | 1;
+    memset(mask, 0, BLOOM_D_BLOCK_BYTES);
+    for (uint32_t i = 0; i < k; i++, a += b) {
+        const uint32_t bit = a >> 23; // 0..511
+        mask[bit >> 6] |= UINT64_C(1) << (bit & 63);
+    }
+}
+
+// 1 if all bits of mask are set in block
+int bloom_d_test_block(const uint64_t* block, const uint64_t* mask) {
+#if defined(__AVX2__)
+    const __m256i b0 = _mm256_load_si256((const __m256i*)block);
+    const __m256i b1 = _mm256_load_si256((const __m256i*)block + 1);
+    const __m256i m0 = _mm256_loadu_si256((const __m256i*)mask);
+    const __m256i m1 = _mm256_loadu_si256((const __m256i*)mask + 1);
+    return _mm256_testc_si256(b0, m0) & _mm256_testc_si256(b1, m1);
+#elif defined(__SSE4_1__)
+    int out = 1;
+    for (size_t i = 0; i < 4; i++)
+        out &= _mm_testc_si128(
+            _mm_load_si128((const __m128i*)block + i),
+            _mm_loadu_si128((const __m128i*)mask + i));
+    return out;
+#else
+    uint64_t missing = 0;
+    for (size_t i = 0; i < BLOOM_D_BLOCK_WORDS; i++)
+        missing |= mask[i] & ~block[i];
+    return missing == 0;
+#endif
+}
+
+const uint64_t* bloom_d_block(const bloom_t* bf, uint64_t hash) {
+    return bf->blocks + bloom_d_block_index(hash, bf->nblocks) * BLOOM_D_BLOCK_WORDS;
+}
+
+int bloom_init(bloom_t* bf, uint64_t expected_keys, double fp_rate,
+    bloom_hash_kind kind, siphash_key_t key) {
+    memset(bf, 0, sizeof *bf);
+    if (expected_keys == 0 || !(fp_rate > 0 && fp_rate < 1) || (uint32_t)kind > BLOOM_HASH_SIPHASH_2_4)
+        return -1;
+
+    const double ln2  = 0.69314718055994530942;
+    const double bits = -(double)expected_keys * log(fp_rate) / (ln2 * ln2);
+    double k = bits / (double)expected_keys * ln2 + 0.5;
+    if (k < 1) k = 1;
+    if (k > 16) k = 16;
+
+    bf->nblocks   = (uint64_t)(bits / (BLOOM_D_BLOCK_BYTES * 8)) + 1;
+    bf->k         = (uint32_t)k;
+    bf->hash_kind = (uint32_t)kind;
+    bf->key       = key;
+
+    void* blocks = NULL;
+    if (posix_memalign(&blocks, BLOOM_D_BLOCK_BYTES, bf->nblocks * BLOOM_D_BLOCK_BYTES) != 0)
+        return -1;
+    bf->blocks = (uint64_t*)blocks;
+    bf->owned  = 1;
+    bloom_clear(bf);
+    return 0;
+}
+
+void bloom_free(bloom_t* bf) {
+    if (bf->mapping)
+        munmap(bf->mapping, bf->mapping_size);
+    else if (bf->owned)
+        free(bf->blocks);
+    memset(bf, 0, sizeof *bf);
+}
+
+void bloom_clear(bloom_t* bf) {
+    memset(bf->blocks, 0, bf->nblocks * BLOOM_D_BLOCK_BYTES);
+}
+
+uint64_t bloom_hash(const bloom_t* bf, const void* source, size_t count) {
+    if (bf->hash_kind == BLOOM_HASH_SIPHASH_2_4)
+        return siphash_2_4(bf->key, source, count);
+    // last bytes of key barely reach high bits of fnv1a_64
+    uint64_t h = fnv1a_64(source, count);
+    h = (h ^ (h >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+    h = (h ^ (h >> 33)) * UINT64_C(0xc4ceb9fe1a85ec53);
+    return h ^ (h >> 33);
+}
+
+void bloom_insert_hash(bloom_t* bf, uint64_t hash) {
+    uint64_t mask[BLOOM_D_BLOCK_WORDS];
+    bloom_d_make_mask(mask, hash, bf->k);
+    uint64_t* block = (uint64_t*)bloom_d_block(bf, hash);
+    for (size_t i = 0; i < BLOOM_D_BLOCK_WORDS; i++)
+        block[i] |= mask[i];
+}
+
+int bloom_query_hash(const bloom_t* bf, uint64_t hash) {
+    uint64_t mask[BLOOM_D_BLOCK_WORDS];
+    bloom_d_make_mask(mask, hash, bf->k);
+    return bloom_d_test_block(bloom_d_block(bf, hash), mask);
+}
+
+void bloom_insert(bloom_t* bf, const void* source, size_t count) {
+    bloom_insert_hash(bf, bloom_hash(bf, source, count));
+}
+
+int bloom_query(const bloom_t* bf, const void* source, size_t count) {
+    return bloom_query_hash(bf, bloom_hash(bf, source, count));
+}
+
+// hash chunk of keys and prefetch their blocks before touching them
+size_t bloom_d_hash_chunk(const bloom_t* bf, const void* const* keys,
+    const size_t* counts, size_t n, uint64_t hashes[BLOOM_D_BATCH]) {
+    const size_t m = n < BLOOM_D_BATCH ? n : BLOOM_D_BATCH;
+    for (size_t i = 0; i < m; i++) {
+        hashes[i] = bloom_hash(bf, keys[i], counts[i]);
+#if defined(__GNUC__)
+        __builtin_prefetch(bloom_d_block(bf, hashes[i]));
+#endif
+    }
+    return m;
+}
+
+void bloom_insert_batch(bloom_t* bf,
+    const void* const* keys, const size_t* counts, size_t n) {
+    uint64_t hashes[BLOOM_D_BATCH];
+    while (n > 0) {
+        const size_t m = bloom_d_hash_chunk(bf, keys, counts, n, hashes);
+        for (size_t i = 0; i < m; i++)
+            bloom_insert_hash(bf, hashes[i]);
+        keys += m, counts += m, n -= m;
+    }
+}
+
+void bloom_query_batch(const bloom_t* bf,
+    const void* const* keys, const size_t* counts, size_t n, uint8_t* result) {
+    uint64_t hashes[BLOOM_D_BATCH];
+    while (n > 0) {
+        const size_t m = bloom_d_hash_chunk(bf, keys, counts, n, hashes);
+        for (size_t i = 0; i < m; i++)
+            result[i] = (uint8_t)bloom_query_hash(bf, hashes[i]);
+        keys += m, counts += m, result += m, n -= m;
+    }
+}
+
+size_t bloom_serialized_size(const bloom_t* bf) {
+    return BLOOM_D_HEADER_BYTES + bf->nblocks * BLOOM_D_BLOCK_BYTES;
+}
+
+int bloom_write(const bloom_t* bf, FILE* file) {
+    uint8_t header[BLOOM_D_HEADER_BYTES] = {0};
+    const uint32_t version = BLOOM_D_VERSION;
+    memcpy(header +  0, bloom_d_magic, 8);
+    memcpy(header +  8, &version, 4);
+    memcpy(header + 12, &bf->k, 4);
+    memcpy(header + 16, &bf->hash_kind, 4);
+    memcpy(header + 32, &bf->nblocks, 8);
+    memcpy(header + 40, &bf->key.low, 8);
+    memcpy(header + 48, &bf->key.high, 8);
+
+    if (fwrite(header, 1, sizeof header, file) != sizeof header)
+        return -1;
+    const size_t bytes = bf->nblocks * BLOOM_D_BLOCK_BYTES;
+    if (fwrite(bf->blocks, 1, bytes, file) != bytes)
+        return -1;
+    return 0;
+}
+
+int bloom_view(bloom_t* bf, const void* data, size_t size) {
+    const uint8_t* header = (const uint8_t*)data;
+    uint32_t version;
+    memset(bf, 0, sizeof *bf);
+
+    if (size < BLOOM_D_HEADER_BYTES || ((uintptr_t)data & (BLOOM_D_BLOCK_BYTES - 1)))
+        return -1;
+    memcpy(&version, header + 8, 4);
+    if (memcmp(header, bloom_d_magic, 8) != 0 || version != BLOOM_D_VERSION)
+        return -1;
+
+    memcpy(&bf->k, header + 12, 4);
+    memcpy(&bf->hash_kind, header + 16, 4);
+    memcpy(&bf->nblocks, header + 32, 8);
+    memcpy(&bf->key.low, header + 40, 8);
+    memcpy(&bf->key.high, header + 48, 8);
+
+    if (bf->nblocks == 0 || bf->k == 0 || bf->k > 16 || bf->hash_kind > BLOOM_HASH_SIPHASH_2_4 ||
+        bf->nblocks > (size - BLOOM_D_HEADER_BYTES) / BLOOM_D_BLOCK_BYTES)
+        return -1;
+    bf->blocks = (uint64_t*)(header + BLOOM_D_HEADER_BYTES);
+    return 0;
+}
+
+int bloom_map_file(bloom_t* bf, const char* path) {
+    memset(bf, 0, sizeof *bf);
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < BLOOM_D_HEADER_BYTES) {
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)st.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return -1;
+
+    if (bloom_view(bf, mapping, size) != 0) {
+        munmap(mapping, size);
+        return -1;
+    }
+    bf->mapping = mapping;
+    bf->mapping_size = size;
+    return 0;
+}
+
+#endif // BLOOM_IMPLEMENTATION
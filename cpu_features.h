@@ -0,0 +1,239 @@
+/* Runtime CPU feature detection and kernel dispatch in C */
+/*
+Shared by headers with SIMD paths. Features are read once by CPUID (and
+XGETBV for OS support of AVX/AVX-512 state), lazily and thread-safe by
+pthread_once.
+
+Features are grouped in tiers, kernel is usually written per tier:
+  baseline - SSE2 on x86-64, plain C elsewhere
+  sse4.1   - + SSSE3, SSE4.1, SSE4.2, POPCNT, SHA-NI
+  avx2     - + AVX, AVX2, BMI2
+  avx512   - + AVX-512 F, BW, VL
+
+Tier can be lowered (never raised above detected) to test every path on
+one machine:
+  SOH_CPU_TIER=baseline|sse4.1|avx2|avx512   - environment variable
+  #define CPU_FEATURES_FORCE_TIER CPU_TIER_X - at compile time
+cpu_features() and cpu_tier() give features after that limit.
+
+Dispatch by function pointers, list is ordered from best to baseline:
+  static const cpu_impl_t impls[] = {
+      { CPU_FEATURE_AVX2,  (cpu_fn_t)sum_avx2 },
+      { CPU_FEATURE_SSE41, (cpu_fn_t)sum_sse41 },
+      { 0,                 (cpu_fn_t)sum_generic },
+  };
+  sum_fn sum = (sum_fn)cpu_select(impls, 3);
+
+Dispatch by GNU ifunc (ELF, GCC or Clang, C only: ifunc names resolver by
+symbol, which is mangled in C++), resolver runs while program is loaded,
+before environment may be read, so it must use cpu_features_detect and only
+CPU_FEATURES_FORCE_TIER applies:
+  static sum_fn sum_resolve(void) { return cpu_features_detect() & CPU_FEATURE_AVX2 ? sum_avx2 : sum_generic; }
+  CPU_IFUNC(uint64_t, sum, (const void* p, size_t n), sum_resolve)
+
+For linking need define in one translation unit:
+  CPU_FEATURES_IMPLEMENTATION
+*/
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CPU_FEATURES_DEF
+#define CPU_FEATURES_DEF
+#endif
+
+#if defined(__GNUC__) && defined(__ELF__) && (defined(__x86_64__) || defined(__i386__)) \
+    && !defined(__cplusplus)
+#define CPU_FEATURES_HAS_IFUNC 1
+#define CPU_IFUNC(ret, name, params, resolver) \
+    ret name params __attribute__((ifunc(#resolver)));
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CPU_TIER_BASELINE = 0,
+    CPU_TIER_SSE41    = 1,
+    CPU_TIER_AVX2     = 2,
+    CPU_TIER_AVX512   = 3
+} cpu_tier_t;
+
+enum {
+    CPU_FEATURE_SSE2     = 1u << 0,
+    CPU_FEATURE_SSSE3    = 1u << 1,
+    CPU_FEATURE_SSE41    = 1u << 2,
+    CPU_FEATURE_SSE42    = 1u << 3,
+    CPU_FEATURE_POPCNT   = 1u << 4,
+    CPU_FEATURE_SHA      = 1u << 5,
+    CPU_FEATURE_AVX      = 1u << 6,
+    CPU_FEATURE_AVX2     = 1u << 7,
+    CPU_FEATURE_BMI2     = 1u << 8,
+    CPU_FEATURE_AVX512F  = 1u << 9,
+    CPU_FEATURE_AVX512BW = 1u << 10,
+    CPU_FEATURE_AVX512VL = 1u << 11
+};
+
+typedef void (*cpu_fn_t)(void);
+
+typedef struct {
+    uint32_t required; // CPU_FEATURE_* bits, 0 for baseline
+    cpu_fn_t fn;
+} cpu_impl_t;
+
+// CPUID without limits, no state, safe in ifunc resolver
+CPU_FEATURES_DEF uint32_t cpu_features_detect(void);
+
+// detected features limited by forced tier, first call initializes
+CPU_FEATURES_DEF uint32_t cpu_features(void);
+CPU_FEATURES_DEF cpu_tier_t cpu_tier(void);
+CPU_FEATURES_DEF int cpu_has(uint32_t features); // 1 if all are present
+
+// fn of first impl which required features are present, NULL if none
+CPU_FEATURES_DEF cpu_fn_t cpu_select(const cpu_impl_t* impls, size_t count);
+
+CPU_FEATURES_DEF const char* cpu_tier_name(cpu_tier_t tier);
+// -1 if name is unknown
+CPU_FEATURES_DEF int cpu_tier_parse(const char* name);
+// features of tier and all tiers below it
+CPU_FEATURES_DEF uint32_t cpu_tier_features(cpu_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPU_FEATURES_H
+
+#ifdef CPU_FEATURES_IMPLEMENTATION
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+uint32_t cpu_d_features;
+cpu_tier_t cpu_d_tier;
+pthread_once_t cpu_d_once = PTHREAD_ONCE_INIT;
+
+#if defined(__x86_64__) || defined(__i386__)
+uint64_t cpu_d_xgetbv(void) {
+    uint32_t low, high;
+    __asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return ((uint64_t)high << 32) | low;
+}
+#endif
+
+uint32_t cpu_features_detect(void) {
+    uint32_t out = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d))
+        return 0;
+    if (d & (1u << 26)) out |= CPU_FEATURE_SSE2;
+    if (c & (1u <<  9)) out |= CPU_FEATURE_SSSE3;
+    if (c & (1u << 19)) out |= CPU_FEATURE_SSE41;
+    if (c & (1u << 20)) out |= CPU_FEATURE_SSE42;
+    if (c & (1u << 23)) out |= CPU_FEATURE_POPCNT;
+
+    // AVX state must be enabled by OS: OSXSAVE and XCR0 bits of XMM, YMM
+    // and for AVX-512 also opmask, ZMM0-15 high halves and ZMM16-31
+    uint64_t xcr0 = 0;
+    if (c & (1u << 27)) xcr0 = cpu_d_xgetbv();
+    const int os_avx = (xcr0 & 0x06) == 0x06;
+    const int os_avx512 = (xcr0 & 0xe6) == 0xe6;
+    if (os_avx && (c & (1u << 28))) out |= CPU_FEATURE_AVX;
+
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        if (b & (1u << 29)) out |= CPU_FEATURE_SHA;
+        if (b & (1u <<  8)) out |= CPU_FEATURE_BMI2;
+        if (os_avx && (b & (1u << 5))) out |= CPU_FEATURE_AVX2;
+        if (os_avx512) {
+            if (b & (1u << 16)) out |= CPU_FEATURE_AVX512F;
+            if (b & (1u << 30)) out |= CPU_FEATURE_AVX512BW;
+            if (b & (1u << 31)) out |= CPU_FEATURE_AVX512VL;
+        }
+    }
+#endif
+#ifdef CPU_FEATURES_FORCE_TIER
+    out &= cpu_tier_features(CPU_FEATURES_FORCE_TIER);
+#endif
+    return out;
+}
+
+uint32_t cpu_tier_features(cpu_tier_t tier) {
+    uint32_t out = CPU_FEATURE_SSE2;
+    if (tier >= CPU_TIER_SSE41)
+        out |= CPU_FEATURE_SSSE3 | CPU_FEATURE_SSE41 | CPU_FEATURE_SSE42
+             | CPU_FEATURE_POPCNT | CPU_FEATURE_SHA;
+    if (tier >= CPU_TIER_AVX2)
+        out |= CPU_FEATURE_AVX | CPU_FEATURE_AVX2 | CPU_FEATURE_BMI2;
+    if (tier >= CPU_TIER_AVX512)
+        out |= CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512BW | CPU_FEATURE_AVX512VL;
+    return out;
+}
+
+const char* cpu_tier_name(cpu_tier_t tier) {
+    switch (tier) {
+    case CPU_TIER_BASELINE: return "baseline";
+    case CPU_TIER_SSE41:    return "sse4.1";
+    case CPU_TIER_AVX2:     return "avx2";
+    case CPU_TIER_AVX512:   return "avx512";
+    }
+    return "unknown";
+}
+
+int cpu_tier_parse(const char* name) {
+    for (int tier = CPU_TIER_BASELINE; tier <= CPU_TIER_AVX512; tier++)
+        if (strcmp(name, cpu_tier_name((cpu_tier_t)tier)) == 0)
+            return tier;
+    return -1;
+}
+
+void cpu_d_init(void) {
+    uint32_t features = cpu_features_detect();
+    const char* env = getenv("SOH_CPU_TIER");
+    int forced = env ? cpu_tier_parse(env) : -1;
+    if (forced >= 0)
+        features &= cpu_tier_features((cpu_tier_t)forced);
+
+    // highest tier with all its features, lower tiers are its subset
+    cpu_tier_t tier = CPU_TIER_BASELINE;
+    for (int t = CPU_TIER_SSE41; t <= CPU_TIER_AVX512; t++) {
+        const uint32_t need = cpu_tier_features((cpu_tier_t)t)
+            & ~(CPU_FEATURE_SHA | CPU_FEATURE_BMI2); // optional inside tier
+        if ((features & need) != need) break;
+        tier = (cpu_tier_t)t;
+    }
+    cpu_d_features = features;
+    cpu_d_tier = tier;
+}
+
+uint32_t cpu_features(void) {
+    pthread_once(&cpu_d_once, cpu_d_init);
+    return cpu_d_features;
+}
+
+cpu_tier_t cpu_tier(void) {
+    pthread_once(&cpu_d_once, cpu_d_init);
+    return cpu_d_tier;
+}
+
+int cpu_has(uint32_t features) {
+    return (cpu_features() & features) == features;
+}
+
+cpu_fn_t cpu_select(const cpu_impl_t* impls, size_t count) {
+    const uint32_t features = cpu_features();
+    for (size_t i = 0; i < count; i++)
+        if ((features & impls[i].required) == impls[i].required)
+            return impls[i].fn;
+    return NULL;
+}
+
+#endif // CPU_FEATURES_IMPLEMENTATION
@@ -0,0 +1,596 @@
+/*
+Open-addressing hash map with SwissTable-style control bytes,
+C++14 and later
+
+Layout:
+  ctrl  - one byte per slot (empty, deleted or 7 bits of hash),
+          first group_width bytes cloned at the end
+  slots - array of std::pair<const Key, T>
+Lookup loads a group of control bytes (16 with SSE2, 8 otherwise)
+and compares all of them with 7 bits of hash at once
+
+By default keys are hashed with siphash_hasher (hash/hasher.hpp),
+iterators and references are invalidated by rehashing
+*/
+#ifndef FLAT_HASH_MAP_HPP
+#define FLAT_HASH_MAP_HPP
+
+#include <initializer_list>
+#include <type_traits>
+#include <functional>
+#include <stdexcept>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FLAT_HASH_MAP_SSE2
+#endif
+
+#include "hash/hasher.hpp"
+
+namespace impl {
+
+namespace flat_detail {
+
+using ctrl_t = int8_t;
+
+constexpr ctrl_t ctrl_empty   = -128; // 0b10000000
+constexpr ctrl_t ctrl_deleted = -2;   // 0b11111110
+
+inline bool is_full(ctrl_t c) { return c >= 0; }
+
+inline unsigned count_trailing_zeros(uint64_t n) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(n));
+#else
+    unsigned out = 0;
+    for (; (n & 1) == 0; n >>= 1) out++;
+    return out;
+#endif
+}
+
+// iterate over set bits, each bit is one slot in group
+template <unsigned Shift>
+class bit_mask {
+public:
+    explicit bit_mask(uint64_t mask) : m_mask(mask) {}
+
+    explicit operator bool() const { return m_mask != 0; }
+    unsigned lowest() const { return count_trailing_zeros(m_mask) >> Shift; }
+
+    bit_mask& operator++() { m_mask &= m_mask - 1; return *this; }
+    unsigned operator*() const { return lowest(); }
+    bit_mask begin() const { return *this; }
+    bit_mask end() const { return bit_mask(0); }
+    bool operator!=(const bit_mask& rhs) const { return m_mask != rhs.m_mask; }
+
+private:
+    uint64_t m_mask;
+};
+
+#ifdef FLAT_HASH_MAP_SSE2
+
+struct group {
+    static constexpr size_t width = 16;
+
+    explicit group(const ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    bit_mask<0> match(ctrl_t h2) const {
+        return bit_mask<0>(static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+    bit_mask<0> match_empty() const {
+        return match(ctrl_empty);
+    }
+    bit_mask<0> match_empty_or_deleted() const {
+        return bit_mask<0>(static_cast<uint16_t>(_mm_movemask_epi8(ctrl)));
+    }
+
+    __m128i ctrl;
+};
+
+#else
+
+// portable group, SWAR over 8 bytes
+struct group {
+    static constexpr size_t width = 8;
+    static constexpr uint64_t lsbs = UINT64_C(0x0101010101010101);
+    static constexpr uint64_t msbs = UINT64_C(0x8080808080808080);
+
+    explicit group(const ctrl_t* pos) {
+        std::memcpy(&ctrl, pos, sizeof ctrl);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        ctrl = __builtin_bswap64(ctrl);
+#endif
+    }
+
+    // may give false positive after real match, keys are compared anyway
+    bit_mask<3> match(ctrl_t h2) const {
+        const uint64_t x = ctrl ^ (lsbs * static_cast<uint8_t>(h2));
+        return bit_mask<3>((x - lsbs) & ~x & msbs);
+    }
+    bit_mask<3> match_empty() const {
+        return bit_mask<3>(ctrl & ~(ctrl << 6) & msbs);
+    }
+    bit_mask<3> match_empty_or_deleted() const {
+        return bit_mask<3>(ctrl & msbs);
+    }
+
+    uint64_t ctrl;
+};
+
+#endif // FLAT_HASH_MAP_SSE2
+
+inline const ctrl_t* empty_group() {
+    alignas(16) static const ctrl_t out[16] = {
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty
+    };
+    return out;
+}
+
+} // namespace flat_detail
+
+template <typename Map, bool IsConst>
+class Flat_hash_map_iterator {
+    using map_value = typename Map::value_type;
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = map_value;
+    using difference_type   = ptrdiff_t;
+    using reference = typename std::conditional<IsConst, const map_value&, map_value&>::type;
+    using pointer   = typename std::conditional<IsConst, const map_value*, map_value*>::type;
+
+    Flat_hash_map_iterator() = default;
+    Flat_hash_map_iterator(const flat_detail::ctrl_t* ctrl, map_value* slot, const flat_detail::ctrl_t* end)
+        : m_ctrl(ctrl), m_slot(slot), m_end(end) { skip_free(); }
+    template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+    Flat_hash_map_iterator(const Flat_hash_map_iterator<Map, false>& other)
+        : m_ctrl(other.m_ctrl), m_slot(other.m_slot), m_end(other.m_end) {}
+
+    reference operator*() const { return *m_slot; }
+    pointer operator->() const { return m_slot; }
+
+    Flat_hash_map_iterator& operator++() {
+        ++m_ctrl, ++m_slot;
+        skip_free();
+        return *this;
+    }
+    Flat_hash_map_iterator operator++(int) {
+        Flat_hash_map_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    friend bool operator==(const Flat_hash_map_iterator& a, const Flat_hash_map_iterator& b) {
+        return a.m_ctrl == b.m_ctrl;
+    }
+    friend bool operator!=(const Flat_hash_map_iterator& a, const Flat_hash_map_iterator& b) {
+        return a.m_ctrl != b.m_ctrl;
+    }
+
+private:
+    template <typename, bool> friend class Flat_hash_map_iterator;
+    template <typename, typename, typename, typename, typename> friend class Flat_hash_map;
+
+    void skip_free() {
+        while (m_ctrl != m_end && !flat_detail::is_full(*m_ctrl))
+            ++m_ctrl, ++m_slot;
+    }
+
+    const flat_detail::ctrl_t* m_ctrl = nullptr;
+    map_value* m_slot = nullptr;
+    const flat_detail::ctrl_t* m_end  = nullptr;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+class Flat_hash_map {
+    using ctrl_t = flat_detail::ctrl_t;
+    using group  = flat_detail::group;
+    using alloc_traits = typename std::allocator_traits<Allocator>::template rebind_traits<std::pair<const Key, T>>;
+    using ctrl_alloc   = typename alloc_traits::template rebind_alloc<ctrl_t>;
+    using ctrl_traits  = typename alloc_traits::template rebind_traits<ctrl_t>;
+
+public:
+    using key_type        = Key;
+    using mapped_type     = T;
+    using value_type      = std::pair<const Key, T>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using allocator_type  = typename alloc_traits::allocator_type;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    using iterator        = Flat_hash_map_iterator<Flat_hash_map, false>;
+    using const_iterator  = Flat_hash_map_iterator<Flat_hash_map, true>;
+
+public:
+    Flat_hash_map() = default;
+    explicit Flat_hash_map(size_type bucket_count,
+        const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(),
+        const Allocator& alloc = Allocator())
+        : m_hash(hash), m_equal(equal), m_alloc(alloc) { reserve(bucket_count); }
+    Flat_hash_map(std::initializer_list<value_type> il) {
+        reserve(il.size());
+        for (const auto& v : il) insert(v);
+    }
+    ~Flat_hash_map() { destroy(); }
+
+    Flat_hash_map(const Flat_hash_map& other)
+        : m_hash(other.m_hash), m_equal(other.m_equal),
+          m_alloc(alloc_traits::select_on_container_copy_construction(other.m_alloc)) {
+        reserve(other.size());
+        for (const auto& v : other) insert_unique(v);
+    }
+    Flat_hash_map(Flat_hash_map&& other) noexcept
+        : m_hash(std::move(other.m_hash)), m_equal(std::move(other.m_equal)),
+          m_alloc(std::move(other.m_alloc)) {
+        steal(other);
+    }
+
+    Flat_hash_map& operator=(const Flat_hash_map& other) {
+        if (this != &other) {
+            Flat_hash_map tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+    Flat_hash_map& operator=(Flat_hash_map&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            m_hash  = std::move(other.m_hash);
+            m_equal = std::move(other.m_equal);
+            m_alloc = std::move(other.m_alloc);
+            steal(other);
+        }
+        return *this;
+    }
+
+public: // iterators
+    iterator begin() { return iterator(m_ctrl, m_slots, m_ctrl + m_capacity); }
+    iterator end()   { return iterator(m_ctrl + m_capacity, m_slots + m_capacity, m_ctrl + m_capacity); }
+    const_iterator begin() const { return const_cast<Flat_hash_map*>(this)->begin(); }
+    const_iterator end()   const { return const_cast<Flat_hash_map*>(this)->end(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
+
+public: // capacity
+    bool empty() const noexcept { return m_size == 0; }
+    size_type size() const noexcept { return m_size; }
+    size_type capacity() const noexcept { return m_capacity; }
+    float load_factor() const noexcept {
+        return m_capacity ? float(m_size) / float(m_capacity) : 0.f;
+    }
+
+public: // lookup
+    iterator find(const Key& key) {
+        const size_t index = find_index(key, m_hash(key));
+        return index == npos ? end() : iterator_at(index);
+    }
+    const_iterator find(const Key& key) const {
+        return const_cast<Flat_hash_map*>(this)->find(key);
+    }
+    bool contains(const Key& key) const { return find_index(key, m_hash(key)) != npos; }
+    size_type count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    T& at(const Key& key) {
+        const size_t index = find_index(key, m_hash(key));
+        if (index == npos)
+            throw std::out_of_range("Flat_hash_map::at: key not found");
+        return m_slots[index].second;
+    }
+    const T& at(const Key& key) const {
+        return const_cast<Flat_hash_map*>(this)->at(key);
+    }
+
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+public: // modifiers
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return try_emplace(value.first, std::move(value.second));
+    }
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        auto res = try_emplace(key, std::forward<M>(obj));
+        if (!res.second) res.first->second = std::forward<M>(obj);
+        return res;
+    }
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        auto res = try_emplace(std::move(key), std::forward<M>(obj));
+        if (!res.second) res.first->second = std::forward<M>(obj);
+        return res;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type tmp(std::forward<Args>(args)...);
+        return insert(std::move(tmp));
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const size_t hash = m_hash(key);
+        size_t index = find_index(key, hash);
+        if (index != npos)
+            return {iterator_at(index), false};
+
+        index = prepare_insert(hash);
+        try {
+            alloc_traits::construct(m_alloc, m_slots + index, std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        } catch (...) {
+            unprepare_insert(index);
+            throw;
+        }
+        set_ctrl(index, h2(hash));
+        ++m_size;
+        return {iterator_at(index), true};
+    }
+
+    size_type erase(const Key& key) {
+        const size_t index = find_index(key, m_hash(key));
+        if (index == npos) return 0;
+        erase_at(index);
+        return 1;
+    }
+    iterator erase(const_iterator pos) {
+        const size_t index = static_cast<size_t>(pos.m_ctrl - m_ctrl);
+        erase_at(index);
+        return iterator_at(index + 1);
+    }
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    void clear() noexcept {
+        if (m_capacity == 0) return;
+        for (size_t i = 0; i < m_capacity; i++)
+            if (flat_detail::is_full(m_ctrl[i]))
+                alloc_traits::destroy(m_alloc, m_slots + i);
+        std::memset(m_ctrl, flat_detail::ctrl_empty, m_capacity + group::width);
+        m_size = 0;
+        reset_growth_left();
+    }
+
+    void swap(Flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(m_hash, other.m_hash);
+        swap(m_equal, other.m_equal);
+        swap(m_alloc, other.m_alloc);
+        swap(m_ctrl, other.m_ctrl);
+        swap(m_slots, other.m_slots);
+        swap(m_capacity, other.m_capacity);
+        swap(m_size, other.m_size);
+        swap(m_growth_left, other.m_growth_left);
+    }
+
+public: // hash policy
+    void reserve(size_type count) {
+        if (count > m_size + m_growth_left)
+            rehash(count + count / 7 + 1);
+    }
+    void rehash(size_type count) {
+        size_t cap = group::width;
+        while (cap < count || cap - cap / 8 < m_size) cap *= 2;
+        if (cap != m_capacity) resize(cap);
+    }
+
+    hasher hash_function() const { return m_hash; }
+    key_equal key_eq() const { return m_equal; }
+    allocator_type get_allocator() const { return allocator_type(m_alloc); }
+
+private:
+    static constexpr size_t npos = size_t(-1);
+
+    static size_t h1(size_t hash) { return hash >> 7; }
+    static ctrl_t h2(size_t hash) { return static_cast<ctrl_t>(hash & 0x7f); }
+
+    iterator iterator_at(size_t index) {
+        return iterator(m_ctrl + index, m_slots + index, m_ctrl + m_capacity);
+    }
+
+    // triangular probing over groups, visits every group once
+    template <typename K>
+    size_t find_index(const K& key, size_t hash) const {
+        if (m_capacity == 0) return npos;
+        const size_t mask = m_capacity - 1;
+        size_t offset = h1(hash) & mask, step = 0;
+        for (;;) {
+            const group g(m_ctrl + offset);
+            for (unsigned i : g.match(h2(hash))) {
+                const size_t index = (offset + i) & mask;
+                if (m_equal(m_slots[index].first, key))
+                    return index;
+            }
+            if (g.match_empty()) return npos;
+            step += group::width;
+            offset = (offset + step) & mask;
+        }
+    }
+
+    size_t find_first_free(size_t hash) const {
+        return find_first_free(m_ctrl, m_capacity, hash);
+    }
+    static size_t find_first_free(const ctrl_t* ctrl, size_t capacity, size_t hash) {
+        const size_t mask = capacity - 1;
+        size_t offset = h1(hash) & mask, step = 0;
+        for (;;) {
+            const auto free = group(ctrl + offset).match_empty_or_deleted();
+            if (free) return (offset + free.lowest()) & mask;
+            step += group::width;
+            offset = (offset + step) & mask;
+        }
+    }
+
+    size_t prepare_insert(size_t hash) {
+        size_t index = m_capacity ? find_first_free(hash) : npos;
+        if (index == npos || (m_growth_left == 0 && m_ctrl[index] != flat_detail::ctrl_deleted)) {
+            // drop tombstones in place while table is at most half full
+            if (m_capacity && m_size <= m_capacity / 2 - m_capacity / 16)
+                resize(m_capacity);
+            else
+                resize(m_capacity ? m_capacity * 2 : group::width);
+            index = find_first_free(hash);
+        }
+        if (m_ctrl[index] == flat_detail::ctrl_empty)
+            --m_growth_left;
+        return index;
+    }
+    // slot from prepare_insert stays free because construction threw
+    void unprepare_insert(size_t index) noexcept {
+        if (m_ctrl[index] == flat_detail::ctrl_empty)
+            ++m_growth_left;
+    }
+
+    void set_ctrl(size_t index, ctrl_t c) {
+        set_ctrl(m_ctrl, m_capacity, index, c);
+    }
+    static void set_ctrl(ctrl_t* ctrl, size_t capacity, size_t index, ctrl_t c) {
+        ctrl[index] = c;
+        if (index < group::width)
+            ctrl[capacity + index] = c;
+    }
+
+    void erase_at(size_t index) {
+        alloc_traits::destroy(m_alloc, m_slots + index);
+        set_ctrl(index, flat_detail::ctrl_deleted);
+        --m_size;
+    }
+
+    void reset_growth_left() {
+        m_growth_left = m_capacity - m_capacity / 8 - m_size;
+    }
+
+    void resize(size_t new_capacity) {
+        ctrl_t* old_ctrl = m_ctrl;
+        pointer old_slots = m_slots;
+        const size_t old_capacity = m_capacity;
+
+        // map is untouched until both arrays are allocated
+        ctrl_alloc calloc(m_alloc);
+        ctrl_t* new_ctrl = ctrl_traits::allocate(calloc, new_capacity + group::width);
+        pointer new_slots;
+        try {
+            new_slots = alloc_traits::allocate(m_alloc, new_capacity);
+        } catch (...) {
+            ctrl_traits::deallocate(calloc, new_ctrl, new_capacity + group::width);
+            throw;
+        }
+        std::memset(new_ctrl, flat_detail::ctrl_empty, new_capacity + group::width);
+
+        // old slots are destroyed only after all are in new table, elements
+        // with throwing move are copied, so exception leaves map unchanged
+        try {
+            for (size_t i = 0; i < old_capacity; i++) {
+                if (!flat_detail::is_full(old_ctrl[i])) continue;
+                const size_t hash  = m_hash(old_slots[i].first);
+                const size_t index = find_first_free(new_ctrl, new_capacity, hash);
+                alloc_traits::construct(m_alloc, new_slots + index,
+                    std::move_if_noexcept(const_cast<Key&>(old_slots[i].first)),
+                    std::move_if_noexcept(old_slots[i].second));
+                set_ctrl(new_ctrl, new_capacity, index, h2(hash));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < new_capacity; i++)
+                if (flat_detail::is_full(new_ctrl[i]))
+                    alloc_traits::destroy(m_alloc, new_slots + i);
+            ctrl_traits::deallocate(calloc, new_ctrl, new_capacity + group::width);
+            alloc_traits::deallocate(m_alloc, new_slots, new_capacity);
+            throw;
+        }
+        for (size_t i = 0; i < old_capacity; i++)
+            if (flat_detail::is_full(old_ctrl[i]))
+                alloc_traits::destroy(m_alloc, old_slots + i);
+
+        m_ctrl = new_ctrl;
+        m_slots = new_slots;
+        m_capacity = new_capacity;
+        reset_growth_left();
+
+        if (old_capacity) {
+            ctrl_traits::deallocate(calloc, old_ctrl, old_capacity + group::width);
+            alloc_traits::deallocate(m_alloc, old_slots, old_capacity);
+        }
+    }
+
+    void insert_unique(const value_type& value) {
+        const size_t hash  = m_hash(value.first);
+        const size_t index = prepare_insert(hash);
+        try {
+            alloc_traits::construct(m_alloc, m_slots + index, value);
+        } catch (...) {
+            unprepare_insert(index);
+            throw;
+        }
+        set_ctrl(index, h2(hash));
+        ++m_size;
+    }
+
+    void destroy() {
+        if (m_capacity == 0) return;
+        clear();
+        ctrl_alloc calloc(m_alloc);
+        ctrl_traits::deallocate(calloc, m_ctrl, m_capacity + group::width);
+        alloc_traits::deallocate(m_alloc, m_slots, m_capacity);
+        release();
+    }
+
+    void steal(Flat_hash_map& other) {
+        m_ctrl  = other.m_ctrl;
+        m_slots = other.m_slots;
+        m_capacity    = other.m_capacity;
+        m_size        = other.m_size;
+        m_growth_left = other.m_growth_left;
+        other.release();
+    }
+
+    void release() {
+        m_ctrl  = const_cast<ctrl_t*>(flat_detail::empty_group());
+        m_slots = nullptr;
+        m_capacity = m_size = m_growth_left = 0;
+    }
+
+private:
+    Hash m_hash {};
+    KeyEqual m_equal {};
+    allocator_type m_alloc {};
+    ctrl_t* m_ctrl = const_cast<ctrl_t*>(flat_detail::empty_group());
+    pointer m_slots = nullptr;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    size_t m_growth_left = 0;
+}; // class Flat_hash_map
+
+} // namespace impl
+
+template <
+    typename Key, typename T,
+    typename Hash = siphash_hasher<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Allocator = std::allocator<std::pair<const Key, T>>
+> using flat_hash_map = impl::Flat_hash_map<Key, T, Hash, KeyEqual, Allocator>;
+
+namespace std {
+    template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+    void swap(impl::Flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& a,
+              impl::Flat_hash_map<Key, T, Hash, KeyEqual, Allocator>& b)
+    noexcept(noexcept(a.swap(b))) { a.swap(b); }
+}
+
+#endif // FLAT_HASH_MAP_HPP
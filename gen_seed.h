@@ -3,22 +3,68 @@
 
 // from: https://stackoverflow.com/questions/322938/
 
+/*
+generate_seed_bytes mixes once per process (and again after fork):
+  getrandom(GRND_NONBLOCK), time, clock, pid, ASLR addresses
+and on each call without syscall:
+  per-process atomic counter, rdtsc or CLOCK_MONOTONIC, thread id
+so workers started at the same moment get different seeds
+
+gs_seed_seq is C++ SeedSeq over generate_seed_bytes:
+  gs_seed_seq seq;
+  xorshift gen(seq);
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 unsigned long gs_mix3(unsigned long a, unsigned long b, unsigned long c);
 unsigned long generate_seed(void);
+void generate_seed_bytes(void* buffer, size_t count);
 
 #ifdef __cplusplus
 }
+
+class gs_seed_seq {
+public:
+    using result_type = uint_least32_t;
+
+    gs_seed_seq() = default;
+    gs_seed_seq(const gs_seed_seq&) = delete;
+    gs_seed_seq& operator=(const gs_seed_seq&) = delete;
+
+    template <class RandomIt>
+    void generate(RandomIt first, RandomIt last) {
+        uint32_t buf[16];
+        while (first != last) {
+            const size_t n = last - first < 16 ? size_t(last - first) : 16;
+            generate_seed_bytes(buf, n * sizeof *buf);
+            for (size_t i = 0; i < n; i++)
+                *first++ = buf[i];
+        }
+    }
+
+    size_t size() const { return 0; }
+    template <class OutputIt>
+    void param(OutputIt) const {}
+};
 #endif
 
 #ifdef GEN_SEED_IMPLEMENTATION
 
+#include <pthread.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
 unsigned long gs_mix3(unsigned long a, unsigned long b, unsigned long c) {
     a -= b; a -= c; a ^= (c >> 13);
     b -= c; b -= a; b ^= (a <<  8);
@@ -32,10 +78,76 @@ unsigned long gs_mix3(unsigned long a, unsigned long b, unsigned long c) {
     return c;
 }
 
+uint64_t gs_d_pool[4];
+uint64_t gs_d_counter;
+pthread_once_t gs_d_once = PTHREAD_ONCE_INIT;
+__thread char gs_d_thread_tag;
+
+uint64_t gs_d_mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+}
+
+uint64_t gs_d_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void gs_d_reseed(void) {
+    uint64_t pool[4] = {0};
+#if defined(__linux__)
+    if (getrandom(pool, sizeof pool, GRND_NONBLOCK) != (ssize_t)sizeof pool)
+        memset(pool, 0, sizeof pool); // no entropy yet, rely on the rest
+#endif
+    uint64_t local = 0;
+    pool[0] ^= (uint64_t)time(0);
+    pool[1] ^= (uint64_t)clock() ^ ((uint64_t)getpid() << 32);
+    pool[2] ^= (uint64_t)(uintptr_t)&local ^ (uint64_t)(uintptr_t)&gs_d_pool;
+    pool[3] ^= (uint64_t)(uintptr_t)&gs_d_reseed ^ gs_d_ticks();
+
+    for (size_t i = 0; i < 4; i++)
+        gs_d_pool[i] = gs_d_mix64(pool[i] + gs_d_mix64(pool[(i + 1) % 4] + i));
+}
+
+void gs_d_init(void) {
+    gs_d_reseed();
+    pthread_atfork(NULL, NULL, gs_d_reseed);
+}
+
+void generate_seed_bytes(void* buffer, size_t count) {
+    pthread_once(&gs_d_once, gs_d_init);
+
+    const uint64_t ctr = __atomic_fetch_add(&gs_d_counter, 1, __ATOMIC_RELAXED);
+    const uint64_t tid = (uint64_t)(uintptr_t)&gs_d_thread_tag;
+
+    uint64_t a = gs_d_pool[0] ^ gs_d_mix64(ctr ^ gs_d_pool[2]);
+    uint64_t b = gs_d_pool[1] ^ gs_d_mix64(gs_d_ticks() ^ gs_d_pool[3]);
+    a = gs_d_mix64(a ^ tid);
+    b = gs_d_mix64(b + a);
+
+    uint8_t* out = (uint8_t*)buffer;
+    while (count > 0) {
+        a += UINT64_C(0x9e3779b97f4a7c15);
+        b += UINT64_C(0xd1b54a32d192ed03);
+        const uint64_t block = gs_d_mix64(a) ^ gs_d_mix64(b ^ (a >> 29));
+        const size_t n = count < sizeof block ? count : sizeof block;
+        memcpy(out, &block, n);
+        out += n, count -= n;
+    }
+}
+
 unsigned long generate_seed(void) {
-    return gs_mix3(clock(), time(0), getpid());
+    unsigned long out;
+    generate_seed_bytes(&out, sizeof out);
+    return out;
 }
 
 #endif // GEN_SEED_IMPLEMENTATION
 
-#endif // GEN_SEED_H
\ No newline at end of file
+#endif // GEN_SEED_H
@@ -0,0 +1,681 @@
+/* Asynchronous batched file hashing in C: io_uring with pread thread pool fallback */
+/*
+  async_hash_t* ah = async_hash_create(NULL);       // NULL - default config
+  for (size_t i = 0; i < n; i++)
+      async_hash_submit(ah, paths[i], ASYNC_HASH_SHA256, &digests[i]);
+  async_hash_run(ah, on_done, context);             // callbacks in this thread
+  async_hash_destroy(ah);
+
+Files are read by blocks of 'block_size' and fed to streaming state
+(sha256_ctx_t, siphash_ctx_t or fnv1a_64_update), so memory does not
+depend on file size. Backend is chosen by async_hash_create:
+  io_uring - Linux 5.6+ by raw syscalls, up to 'queue_depth' files are
+             processed at once, each has one openat/read/close in flight,
+             new requests of all files go to kernel by one io_uring_enter
+  pread    - 'threads' workers open, pread and close files, results are
+             passed to thread in async_hash_run; used if io_uring is
+             missing, disabled (io_uring_disabled, seccomp) or forced
+Callback may submit more files, run returns when all are done.
+
+For linking need define in one translation unit:
+  ASYNC_HASH_IMPLEMENTATION, SHA256_IMPLEMENTATION,
+  SIPHASH_IMPLEMENTATION, FNV_IMPLEMENTATION
+and link with -pthread; with strict -std=c99/c11 that translation unit
+needs _GNU_SOURCE defined before first include (gnu modes and C++ have it)
+*/
+#ifndef ASYNC_HASH_H
+#define ASYNC_HASH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sha256.h"
+#include "siphash.h"
+#include "fnv.h"
+
+#ifndef ASYNC_HASH_DEF
+#define ASYNC_HASH_DEF
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ASYNC_HASH_SHA256      = 0,
+    ASYNC_HASH_SIPHASH_2_4 = 1,
+    ASYNC_HASH_FNV1A_64    = 2
+} async_hash_kind;
+
+typedef enum {
+    ASYNC_HASH_BACKEND_URING = 0,
+    ASYNC_HASH_BACKEND_PREAD = 1
+} async_hash_backend;
+
+typedef struct {
+    unsigned queue_depth; // files in flight with io_uring
+    unsigned threads;     // workers of pread backend
+    size_t block_size;    // bytes per read
+    int force_pread;      // do not try io_uring
+    siphash_key_t key;    // for ASYNC_HASH_SIPHASH_2_4
+} async_hash_config_t;
+
+typedef struct {
+    const char* path;
+    void* user;           // as given to async_hash_submit
+    async_hash_kind kind;
+    int error;            // 0 or errno value, digest is not set on error
+    uint64_t size;        // hashed bytes
+    sha256_hash_t sha256; // ASYNC_HASH_SHA256
+    uint64_t value;       // ASYNC_HASH_SIPHASH_2_4, ASYNC_HASH_FNV1A_64
+} async_hash_result_t;
+
+typedef void (*async_hash_callback_t)(const async_hash_result_t* result, void* context);
+
+typedef struct async_hash async_hash_t;
+
+// all functions returning int give 0 on success and -1 on error
+
+ASYNC_HASH_DEF async_hash_config_t async_hash_default_config(void);
+ASYNC_HASH_DEF async_hash_t* async_hash_create(const async_hash_config_t* config); // NULL on error
+ASYNC_HASH_DEF void async_hash_destroy(async_hash_t* ah);
+ASYNC_HASH_DEF async_hash_backend async_hash_get_backend(const async_hash_t* ah);
+
+// 'path' is copied
+ASYNC_HASH_DEF int async_hash_submit(async_hash_t* ah,
+    const char* path, async_hash_kind kind, void* user);
+// processes submitted files, callback gets every result once
+ASYNC_HASH_DEF int async_hash_run(async_hash_t* ah,
+    async_hash_callback_t callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASYNC_HASH_H
+
+#ifdef ASYNC_HASH_IMPLEMENTATION
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IO_URING_OP_SUPPORTED)
+#define ASYNC_HASH_URING 1
+#endif
+#endif
+#endif
+
+typedef struct {
+    char* path;
+    void* user;
+    async_hash_kind kind;
+} async_hash_d_job;
+
+typedef union {
+    sha256_ctx_t sha256;
+    siphash_ctx_t siphash;
+    uint64_t fnv;
+} async_hash_d_state;
+
+typedef struct async_hash_d_done {
+    async_hash_result_t result;
+    struct async_hash_d_done* next;
+} async_hash_d_done;
+
+#ifdef ASYNC_HASH_URING
+typedef struct {
+    size_t job;  // SIZE_MAX if slot is free
+    int fd;
+    int opening;
+    uint64_t offset;
+    async_hash_d_state state;
+    async_hash_result_t result;
+    uint8_t* buffer;
+} async_hash_d_slot;
+
+#define ASYNC_HASH_D_CLOSE UINT64_MAX // user_data of close, result is ignored
+#endif
+
+struct async_hash {
+    async_hash_config_t config;
+    async_hash_backend backend;
+
+    pthread_mutex_t mutex; // jobs, next and pread backend state
+    async_hash_d_job* jobs;
+    size_t count, capacity;
+    size_t next;           // first job not started
+
+    // pread backend
+    pthread_cond_t has_job;
+    pthread_cond_t has_done;
+    async_hash_d_done* done;
+    int stop;
+
+#ifdef ASYNC_HASH_URING
+    int ring_fd;
+    void* sq_ring;
+    void* cq_ring;
+    size_t sq_ring_size, cq_ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe* cqes;
+    unsigned to_submit;
+    unsigned closing;      // close requests in flight
+    int has_close_op;
+#endif
+};
+
+void async_hash_d_begin(async_hash_d_state* state, async_hash_kind kind, siphash_key_t key) {
+    switch (kind) {
+    case ASYNC_HASH_SHA256:      sha256_init(&state->sha256); break;
+    case ASYNC_HASH_SIPHASH_2_4: siphash_init(&state->siphash, 2, 4, key); break;
+    case ASYNC_HASH_FNV1A_64:    state->fnv = FNV_64_OFFSET; break;
+    }
+}
+
+void async_hash_d_feed(async_hash_d_state* state, async_hash_kind kind, const void* data, size_t count) {
+    switch (kind) {
+    case ASYNC_HASH_SHA256:      sha256_update(&state->sha256, data, count); break;
+    case ASYNC_HASH_SIPHASH_2_4: siphash_update(&state->siphash, data, count); break;
+    case ASYNC_HASH_FNV1A_64:    state->fnv = fnv1a_64_update(state->fnv, data, count); break;
+    }
+}
+
+void async_hash_d_finish(async_hash_d_state* state, async_hash_result_t* result) {
+    if (result->error) return;
+    switch (result->kind) {
+    case ASYNC_HASH_SHA256:      result->sha256 = sha256_final(&state->sha256); break;
+    case ASYNC_HASH_SIPHASH_2_4: result->value = siphash_final(&state->siphash); break;
+    case ASYNC_HASH_FNV1A_64:    result->value = state->fnv; break;
+    }
+}
+
+void async_hash_d_result(async_hash_result_t* result, const async_hash_d_job* job) {
+    memset(result, 0, sizeof *result);
+    result->path = job->path;
+    result->user = job->user;
+    result->kind = job->kind;
+}
+
+// takes next job under lock, SIZE_MAX if none
+size_t async_hash_d_take(async_hash_t* ah, async_hash_d_job* job) {
+    size_t index = SIZE_MAX;
+    pthread_mutex_lock(&ah->mutex);
+    if (ah->next < ah->count) {
+        index = ah->next++;
+        *job = ah->jobs[index];
+    }
+    pthread_mutex_unlock(&ah->mutex);
+    return index;
+}
+
+/* pread backend */
+
+void async_hash_d_pread_file(async_hash_t* ah, const async_hash_d_job* job,
+    uint8_t* buffer, async_hash_result_t* result) {
+    async_hash_d_state state;
+    async_hash_d_result(result, job);
+    if (!buffer) {
+        result->error = ENOMEM;
+        return;
+    }
+    int fd = open(job->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        result->error = errno;
+        return;
+    }
+    async_hash_d_begin(&state, job->kind, ah->config.key);
+    for (;;) {
+        ssize_t readed = pread(fd, buffer, ah->config.block_size, (off_t)result->size);
+        if (readed < 0 && errno == EINTR) continue;
+        if (readed < 0) result->error = errno;
+        if (readed <= 0) break;
+        async_hash_d_feed(&state, job->kind, buffer, (size_t)readed);
+        result->size += (uint64_t)readed;
+    }
+    close(fd);
+    async_hash_d_finish(&state, result);
+}
+
+void* async_hash_d_worker(void* arg) {
+    async_hash_t* ah = (async_hash_t*)arg;
+    uint8_t* buffer = (uint8_t*)malloc(ah->config.block_size);
+
+    pthread_mutex_lock(&ah->mutex);
+    while (!ah->stop) {
+        if (ah->next >= ah->count) {
+            pthread_cond_wait(&ah->has_job, &ah->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&ah->mutex);
+        async_hash_d_done* done = (async_hash_d_done*)malloc(sizeof *done);
+        async_hash_d_job job;
+        const size_t index = done ? async_hash_d_take(ah, &job) : SIZE_MAX;
+        if (index != SIZE_MAX)
+            async_hash_d_pread_file(ah, &job, buffer, &done->result);
+
+        pthread_mutex_lock(&ah->mutex);
+        if (!done) { // job stays queued, reported by next run
+            ah->stop = 1;
+        } else if (index == SIZE_MAX) { // taken by other worker
+            free(done);
+            continue;
+        } else {
+            done->next = ah->done;
+            ah->done = done;
+        }
+        pthread_cond_signal(&ah->has_done);
+    }
+    pthread_mutex_unlock(&ah->mutex);
+    free(buffer);
+    return NULL;
+}
+
+int async_hash_d_run_pread(async_hash_t* ah, async_hash_callback_t callback, void* context) {
+    pthread_t workers[64];
+    unsigned started = 0;
+    int status = 0;
+    size_t delivered = 0;
+
+    pthread_mutex_lock(&ah->mutex);
+    const size_t first = ah->next;
+    unsigned wanted = ah->config.threads;
+    if (wanted > 64) wanted = 64;
+    if (wanted > ah->count - ah->next) wanted = (unsigned)(ah->count - ah->next);
+    ah->stop = 0;
+    pthread_mutex_unlock(&ah->mutex);
+
+    for (; started < wanted; started++)
+        if (pthread_create(&workers[started], NULL, async_hash_d_worker, ah) != 0)
+            break;
+    if (started == 0 && wanted > 0)
+        status = -1;
+
+    pthread_mutex_lock(&ah->mutex);
+    while (status == 0 && delivered < ah->count - first) {
+        if (!ah->done) {
+            if (ah->stop) { // worker out of memory
+                status = -1;
+                break;
+            }
+            pthread_cond_wait(&ah->has_done, &ah->mutex);
+            continue;
+        }
+        async_hash_d_done* list = ah->done;
+        ah->done = NULL;
+        pthread_mutex_unlock(&ah->mutex);
+        while (list) {
+            async_hash_d_done* next = list->next;
+            callback(&list->result, context);
+            free(list);
+            list = next;
+            delivered++;
+        }
+        pthread_mutex_lock(&ah->mutex);
+    }
+    ah->stop = 1;
+    pthread_cond_broadcast(&ah->has_job);
+    pthread_mutex_unlock(&ah->mutex);
+
+    for (unsigned i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+    // results of workers finished after error
+    while (ah->done) {
+        async_hash_d_done* next = ah->done->next;
+        callback(&ah->done->result, context);
+        free(ah->done);
+        ah->done = next;
+    }
+    return status;
+}
+
+/* io_uring backend */
+
+#ifdef ASYNC_HASH_URING
+
+void async_hash_d_uring_close(async_hash_t* ah) {
+    if (ah->sqes) munmap(ah->sqes, ah->sqes_size);
+    if (ah->cq_ring && ah->cq_ring != ah->sq_ring) munmap(ah->cq_ring, ah->cq_ring_size);
+    if (ah->sq_ring) munmap(ah->sq_ring, ah->sq_ring_size);
+    if (ah->ring_fd >= 0) close(ah->ring_fd);
+    ah->sqes = NULL;
+    ah->sq_ring = ah->cq_ring = NULL;
+    ah->ring_fd = -1;
+}
+
+int async_hash_d_uring_map(async_hash_t* ah, const struct io_uring_params* params) {
+    ah->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    ah->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    const int single = (params->features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && ah->cq_ring_size > ah->sq_ring_size)
+        ah->sq_ring_size = ah->cq_ring_size;
+
+    void* sq = mmap(NULL, ah->sq_ring_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ah->ring_fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) return -1;
+    ah->sq_ring = sq;
+    void* cq = sq;
+    if (!single) {
+        cq = mmap(NULL, ah->cq_ring_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ah->ring_fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) return -1;
+    }
+    ah->cq_ring = cq;
+    ah->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, ah->sqes_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ah->ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return -1;
+    ah->sqes = (struct io_uring_sqe*)sqes;
+
+    ah->sq_head  = (unsigned*)((char*)sq + params->sq_off.head);
+    ah->sq_tail  = (unsigned*)((char*)sq + params->sq_off.tail);
+    ah->sq_mask  = (unsigned*)((char*)sq + params->sq_off.ring_mask);
+    ah->sq_array = (unsigned*)((char*)sq + params->sq_off.array);
+    ah->cq_head  = (unsigned*)((char*)cq + params->cq_off.head);
+    ah->cq_tail  = (unsigned*)((char*)cq + params->cq_off.tail);
+    ah->cq_mask  = (unsigned*)((char*)cq + params->cq_off.ring_mask);
+    ah->cqes     = (struct io_uring_cqe*)((char*)cq + params->cq_off.cqes);
+    return 0;
+}
+
+// openat and read are required, close is optional
+int async_hash_d_uring_probe(async_hash_t* ah) {
+    const size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = (struct io_uring_probe*)calloc(1, probe_size);
+    if (!probe) return -1;
+    const int ok = syscall(__NR_io_uring_register, ah->ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0
+        && probe->last_op >= IORING_OP_READ
+        && (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED)
+        && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    ah->has_close_op = ok && probe->last_op >= IORING_OP_CLOSE
+        && (probe->ops[IORING_OP_CLOSE].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return ok ? 0 : -1;
+}
+
+int async_hash_d_uring_open(async_hash_t* ah) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof params);
+    ah->ring_fd = (int)syscall(__NR_io_uring_setup, 2 * ah->config.queue_depth, &params);
+    if (ah->ring_fd < 0)
+        return -1;
+    if (async_hash_d_uring_map(ah, &params) != 0 || async_hash_d_uring_probe(ah) != 0) {
+        async_hash_d_uring_close(ah);
+        return -1;
+    }
+    return 0;
+}
+
+struct io_uring_sqe* async_hash_d_sqe(async_hash_t* ah, uint8_t opcode, uint64_t user_data) {
+    const unsigned tail = *ah->sq_tail; // written only by this thread
+    const unsigned index = tail & *ah->sq_mask;
+    struct io_uring_sqe* sqe = &ah->sqes[index];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->opcode = opcode;
+    sqe->user_data = user_data;
+    ah->sq_array[index] = index;
+    return sqe;
+}
+
+void async_hash_d_sqe_push(async_hash_t* ah) {
+    __atomic_store_n(ah->sq_tail, *ah->sq_tail + 1, __ATOMIC_RELEASE);
+    ah->to_submit++;
+}
+
+void async_hash_d_submit_read(async_hash_t* ah, async_hash_d_slot* slot, size_t index) {
+    struct io_uring_sqe* sqe = async_hash_d_sqe(ah, IORING_OP_READ, index);
+    sqe->fd = slot->fd;
+    sqe->addr = (uint64_t)(uintptr_t)slot->buffer;
+    sqe->len = (uint32_t)ah->config.block_size;
+    sqe->off = slot->offset;
+    async_hash_d_sqe_push(ah);
+}
+
+void async_hash_d_submit_open(async_hash_t* ah, async_hash_d_slot* slot, size_t index) {
+    struct io_uring_sqe* sqe = async_hash_d_sqe(ah, IORING_OP_OPENAT, index);
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t)(uintptr_t)slot->result.path; // job path, not moved by submit
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    async_hash_d_sqe_push(ah);
+}
+
+// starts next job in free slot, 0 if no job
+int async_hash_d_start(async_hash_t* ah, async_hash_d_slot* slot, size_t index) {
+    async_hash_d_job job;
+    slot->job = async_hash_d_take(ah, &job);
+    if (slot->job == SIZE_MAX)
+        return 0;
+    async_hash_d_result(&slot->result, &job);
+    async_hash_d_begin(&slot->state, job.kind, ah->config.key);
+    slot->fd = -1;
+    slot->opening = 1;
+    slot->offset = 0;
+    async_hash_d_submit_open(ah, slot, index);
+    return 1;
+}
+
+void async_hash_d_finish_slot(async_hash_t* ah, async_hash_d_slot* slot,
+    async_hash_callback_t callback, void* context) {
+    if (slot->fd >= 0) {
+        if (ah->has_close_op) {
+            struct io_uring_sqe* sqe = async_hash_d_sqe(ah, IORING_OP_CLOSE, ASYNC_HASH_D_CLOSE);
+            sqe->fd = slot->fd;
+            async_hash_d_sqe_push(ah);
+            ah->closing++;
+        } else {
+            close(slot->fd);
+        }
+        slot->fd = -1;
+    }
+    async_hash_d_finish(&slot->state, &slot->result);
+    slot->job = SIZE_MAX;
+    callback(&slot->result, context);
+}
+
+// 1 if slot stays busy
+int async_hash_d_complete(async_hash_t* ah, async_hash_d_slot* slot, size_t index, int res,
+    async_hash_callback_t callback, void* context) {
+    if (res == -EINTR || res == -EAGAIN) { // retry same request
+        if (slot->opening) async_hash_d_submit_open(ah, slot, index);
+        else async_hash_d_submit_read(ah, slot, index);
+        return 1;
+    }
+    if (res < 0) {
+        slot->result.error = -res;
+    } else if (slot->opening) {
+        slot->opening = 0;
+        slot->fd = res;
+        async_hash_d_submit_read(ah, slot, index);
+        return 1;
+    } else if (res > 0) {
+        async_hash_d_feed(&slot->state, slot->result.kind, slot->buffer, (size_t)res);
+        slot->offset += (uint64_t)res;
+        slot->result.size += (uint64_t)res;
+        async_hash_d_submit_read(ah, slot, index);
+        return 1;
+    }
+    async_hash_d_finish_slot(ah, slot, callback, context);
+    return async_hash_d_start(ah, slot, index);
+}
+
+int async_hash_d_run_uring(async_hash_t* ah, async_hash_callback_t callback, void* context) {
+    const size_t depth = ah->config.queue_depth;
+    async_hash_d_slot* slots = (async_hash_d_slot*)calloc(depth, sizeof *slots);
+    uint8_t* buffers = (uint8_t*)malloc(depth * ah->config.block_size);
+    if (!slots || !buffers) {
+        free(slots);
+        free(buffers);
+        return -1;
+    }
+
+    size_t active = 0;
+    ah->closing = 0;
+    for (size_t i = 0; i < depth; i++) {
+        slots[i].buffer = buffers + i * ah->config.block_size;
+        slots[i].fd = -1;
+        slots[i].job = SIZE_MAX;
+        active += (size_t)async_hash_d_start(ah, &slots[i], i);
+    }
+
+    int status = 0;
+    while (active > 0 || ah->closing > 0) {
+        int entered = (int)syscall(__NR_io_uring_enter, ah->ring_fd, ah->to_submit, 1,
+            IORING_ENTER_GETEVENTS, NULL, 0);
+        if (entered < 0) {
+            if (errno == EINTR) continue;
+            status = -1;
+            break;
+        }
+        ah->to_submit -= (unsigned)entered;
+
+        unsigned head = *ah->cq_head;
+        const unsigned tail = __atomic_load_n(ah->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const struct io_uring_cqe* cqe = &ah->cqes[head & *ah->cq_mask];
+            const uint64_t user_data = cqe->user_data;
+            const int res = cqe->res;
+            // release cqe before callback may run
+            __atomic_store_n(ah->cq_head, head + 1, __ATOMIC_RELEASE);
+            if (user_data == ASYNC_HASH_D_CLOSE) {
+                ah->closing--;
+                continue;
+            }
+            if (!async_hash_d_complete(ah, &slots[user_data], (size_t)user_data, res, callback, context))
+                active--;
+        }
+    }
+
+    if (status != 0) {
+        // ring is broken: report files in flight, rest is left for pread backend
+        for (size_t i = 0; i < depth; i++) {
+            if (slots[i].job == SIZE_MAX) continue;
+            slots[i].result.error = EIO;
+            if (slots[i].fd >= 0) close(slots[i].fd);
+            slots[i].fd = -1;
+            callback(&slots[i].result, context);
+        }
+        async_hash_d_uring_close(ah); // cancels requests before buffers are freed
+        ah->backend = ASYNC_HASH_BACKEND_PREAD;
+    }
+    free(buffers);
+    free(slots);
+    return status;
+}
+
+#endif // ASYNC_HASH_URING
+
+/* Public API */
+
+async_hash_config_t async_hash_default_config(void) {
+    async_hash_config_t config;
+    memset(&config, 0, sizeof config);
+    config.queue_depth = 64;
+    config.threads = 4;
+    config.block_size = 64 * 1024;
+    return config;
+}
+
+async_hash_t* async_hash_create(const async_hash_config_t* config) {
+    async_hash_t* ah = (async_hash_t*)calloc(1, sizeof *ah);
+    if (!ah) return NULL;
+    ah->config = config ? *config : async_hash_default_config();
+    if (ah->config.queue_depth == 0) ah->config.queue_depth = 1;
+    if (ah->config.queue_depth > 4096) ah->config.queue_depth = 4096;
+    if (ah->config.threads == 0) ah->config.threads = 1;
+    if (ah->config.block_size == 0) ah->config.block_size = 64 * 1024;
+    if (ah->config.block_size > (1u << 30)) ah->config.block_size = 1u << 30;
+
+    pthread_mutex_init(&ah->mutex, NULL);
+    pthread_cond_init(&ah->has_job, NULL);
+    pthread_cond_init(&ah->has_done, NULL);
+
+    ah->backend = ASYNC_HASH_BACKEND_PREAD;
+#ifdef ASYNC_HASH_URING
+    ah->ring_fd = -1;
+    if (!ah->config.force_pread && async_hash_d_uring_open(ah) == 0)
+        ah->backend = ASYNC_HASH_BACKEND_URING;
+#endif
+    return ah;
+}
+
+void async_hash_destroy(async_hash_t* ah) {
+    if (!ah) return;
+#ifdef ASYNC_HASH_URING
+    async_hash_d_uring_close(ah);
+#endif
+    for (size_t i = 0; i < ah->count; i++)
+        free(ah->jobs[i].path);
+    free(ah->jobs);
+    pthread_cond_destroy(&ah->has_done);
+    pthread_cond_destroy(&ah->has_job);
+    pthread_mutex_destroy(&ah->mutex);
+    free(ah);
+}
+
+async_hash_backend async_hash_get_backend(const async_hash_t* ah) {
+    return ah->backend;
+}
+
+int async_hash_submit(async_hash_t* ah, const char* path, async_hash_kind kind, void* user) {
+    if (kind != ASYNC_HASH_SHA256 && kind != ASYNC_HASH_SIPHASH_2_4 && kind != ASYNC_HASH_FNV1A_64)
+        return -1;
+    const size_t length = strlen(path);
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) return -1;
+    memcpy(copy, path, length + 1);
+
+    pthread_mutex_lock(&ah->mutex);
+    if (ah->count == ah->capacity) {
+        const size_t capacity = ah->capacity ? ah->capacity * 2 : 64;
+        async_hash_d_job* jobs = (async_hash_d_job*)realloc(ah->jobs, capacity * sizeof *jobs);
+        if (!jobs) {
+            pthread_mutex_unlock(&ah->mutex);
+            free(copy);
+            return -1;
+        }
+        ah->jobs = jobs;
+        ah->capacity = capacity;
+    }
+    ah->jobs[ah->count].path = copy;
+    ah->jobs[ah->count].user = user;
+    ah->jobs[ah->count].kind = kind;
+    ah->count++;
+    pthread_cond_signal(&ah->has_job);
+    pthread_mutex_unlock(&ah->mutex);
+    return 0;
+}
+
+int async_hash_run(async_hash_t* ah, async_hash_callback_t callback, void* context) {
+    int status = 0;
+#ifdef ASYNC_HASH_URING
+    // on broken ring backend becomes pread and it takes the rest
+    if (ah->backend == ASYNC_HASH_BACKEND_URING)
+        status = async_hash_d_run_uring(ah, callback, context);
+#endif
+    if (ah->backend == ASYNC_HASH_BACKEND_PREAD)
+        status = async_hash_d_run_pread(ah, callback, context);
+
+    // every started job is reported, free paths of them
+    pthread_mutex_lock(&ah->mutex);
+    const size_t rest = ah->count - ah->next;
+    for (size_t i = 0; i < ah->next; i++)
+        free(ah->jobs[i].path);
+    memmove(ah->jobs, ah->jobs + ah->next, rest * sizeof *ah->jobs);
+    ah->count = rest;
+    ah->next = 0;
+    pthread_mutex_unlock(&ah->mutex);
+    return status;
+}
+
+#endif // ASYNC_HASH_IMPLEMENTATION
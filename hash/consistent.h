@@ -0,0 +1,172 @@
+/* Consistent placement of keys to shards in C: jump hash and rendezvous hash */
+/*
+Jump consistent hash (J. Lamping, E. Veach, "A Fast, Minimal Memory,
+Consistent Hash Algorithm", 2014):
+  bucket in [0, buckets) from 64-bit key hash in O(ln buckets), no memory,
+  when buckets grows from n to n + 1 only 1/(n + 1) of keys move, all to
+  new bucket; shards can be added or removed only at the end
+
+Weighted rendezvous (highest random weight) hashing:
+  score(key, shard) = -weight / ln(u), u = mix(key hash, shard id) in (0, 1)
+  key goes to shard with highest score, O(shards) per key; any shard can
+  be removed, only its keys move; share of keys is proportional to weight
+  Key is hashed once by siphash_2_4, per shard score needs only 64-bit mix.
+  If all weights are equal scores are compared without ln.
+
+Keys of *_key and *_batch functions are hashed by fnv1a_64 for jump hash
+(same as 'fnv1a_64(key) % n') and by siphash_2_4 for rendezvous hash.
+
+For linking need define in one translation unit:
+  CONSISTENT_IMPLEMENTATION, SIPHASH_IMPLEMENTATION, FNV_IMPLEMENTATION
+and link with libm (-lm)
+*/
+#ifndef CONSISTENT_H
+#define CONSISTENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "siphash.h"
+#include "fnv.h"
+
+#ifndef CONSISTENT_DEF
+#define CONSISTENT_DEF
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t id;   // stable between resizes, not index
+    double weight; // shards with weight <= 0 get no keys
+} consistent_shard_t;
+
+// all functions returning int give 0 on success and -1 on error
+
+// bucket in [0, buckets), -1 if buckets <= 0
+CONSISTENT_DEF int32_t consistent_jump(uint64_t hash, int32_t buckets);
+CONSISTENT_DEF int32_t consistent_jump_key(const void* source, size_t count, int32_t buckets);
+
+// index in 'shards', -1 if no shard has positive weight
+CONSISTENT_DEF int64_t consistent_hrw(uint64_t hash,
+    const consistent_shard_t* shards, size_t nshards);
+CONSISTENT_DEF int64_t consistent_hrw_key(siphash_key_t key, const void* source, size_t count,
+    const consistent_shard_t* shards, size_t nshards);
+
+// keys[i] with length counts[i], result[i] is bucket or shard index of key
+CONSISTENT_DEF int consistent_jump_batch(
+    const void* const* keys, const size_t* counts, size_t n,
+    int32_t buckets, int32_t* result);
+CONSISTENT_DEF int consistent_hrw_batch(siphash_key_t key,
+    const void* const* keys, const size_t* counts, size_t n,
+    const consistent_shard_t* shards, size_t nshards, int64_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONSISTENT_H
+
+#ifdef CONSISTENT_IMPLEMENTATION
+
+#include <math.h>
+
+// murmur3 64-bit finalizer over key hash and shard id
+uint64_t consistent_d_mix(uint64_t hash, uint64_t id) {
+    uint64_t x = hash ^ (id * UINT64_C(0x9e3779b97f4a7c15));
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x;
+}
+
+// -1 if weights differ or no weight is positive
+double consistent_d_equal_weight(const consistent_shard_t* shards, size_t nshards) {
+    if (nshards == 0 || !(shards[0].weight > 0)) return -1;
+    for (size_t i = 1; i < nshards; i++)
+        if (shards[i].weight != shards[0].weight) return -1;
+    return shards[0].weight;
+}
+
+int64_t consistent_d_hrw_equal(uint64_t hash, const consistent_shard_t* shards, size_t nshards) {
+    int64_t best = 0;
+    uint64_t best_score = consistent_d_mix(hash, shards[0].id);
+    for (size_t i = 1; i < nshards; i++) {
+        const uint64_t score = consistent_d_mix(hash, shards[i].id);
+        if (score > best_score) {
+            best_score = score;
+            best = (int64_t)i;
+        }
+    }
+    return best;
+}
+
+int32_t consistent_jump(uint64_t hash, int32_t buckets) {
+    if (buckets <= 0) return -1;
+    int64_t b = -1, j = 0;
+    while (j < buckets) {
+        b = j;
+        hash = hash * UINT64_C(2862933555777941757) + 1;
+        j = (int64_t)((double)(b + 1) * ((double)(INT64_C(1) << 31) / (double)((hash >> 33) + 1)));
+    }
+    return (int32_t)b;
+}
+
+int32_t consistent_jump_key(const void* source, size_t count, int32_t buckets) {
+    return consistent_jump(fnv1a_64(source, count), buckets);
+}
+
+int64_t consistent_hrw(uint64_t hash, const consistent_shard_t* shards, size_t nshards) {
+    int64_t best = -1;
+    double best_score = 0;
+    for (size_t i = 0; i < nshards; i++) {
+        if (!(shards[i].weight > 0)) continue;
+        // 53 high bits to (0, 1), ln(u) < 0
+        const uint64_t mixed = consistent_d_mix(hash, shards[i].id);
+        const double u = ((double)(mixed >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        const double score = -shards[i].weight / log(u);
+        if (best < 0 || score > best_score) {
+            best_score = score;
+            best = (int64_t)i;
+        }
+    }
+    return best;
+}
+
+int64_t consistent_hrw_key(siphash_key_t key, const void* source, size_t count,
+    const consistent_shard_t* shards, size_t nshards) {
+    return consistent_hrw(siphash_2_4(key, source, count), shards, nshards);
+}
+
+int consistent_jump_batch(
+    const void* const* keys, const size_t* counts, size_t n,
+    int32_t buckets, int32_t* result) {
+    if (buckets <= 0) return -1;
+    for (size_t i = 0; i < n; i++)
+        result[i] = consistent_jump(fnv1a_64(keys[i], counts[i]), buckets);
+    return 0;
+}
+
+int consistent_hrw_batch(siphash_key_t key,
+    const void* const* keys, const size_t* counts, size_t n,
+    const consistent_shard_t* shards, size_t nshards, int64_t* result) {
+    int has_weight = 0;
+    for (size_t i = 0; i < nshards && !has_weight; i++)
+        has_weight = shards[i].weight > 0;
+    if (!has_weight) return -1;
+
+    // equal positive weights: ordering of -w/ln(u) is ordering of u
+    if (consistent_d_equal_weight(shards, nshards) > 0) {
+        for (size_t i = 0; i < n; i++)
+            result[i] = consistent_d_hrw_equal(siphash_2_4(key, keys[i], counts[i]), shards, nshards);
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++)
+        result[i] = consistent_hrw(siphash_2_4(key, keys[i], counts[i]), shards, nshards);
+    return 0;
+}
+
+#endif // CONSISTENT_IMPLEMENTATION
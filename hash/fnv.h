@@ -9,6 +9,9 @@
 #define FNV_DEF
 #endif
 
+#define FNV_32_OFFSET UINT32_C(0x811c9dc5)
+#define FNV_64_OFFSET UINT64_C(0xcbf29ce484222325)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,6 +21,12 @@ FNV_DEF uint32_t fnv1a_32(const void* source, size_t count);
 FNV_DEF uint64_t fnv1_64 (const void* source, size_t count);
 FNV_DEF uint64_t fnv1a_64(const void* source, size_t count);
 
+// continue hash 'out' (FNV_*_OFFSET at start) by next part of data
+FNV_DEF uint32_t fnv1_32_update (uint32_t out, const void* source, size_t count);
+FNV_DEF uint32_t fnv1a_32_update(uint32_t out, const void* source, size_t count);
+FNV_DEF uint64_t fnv1_64_update (uint64_t out, const void* source, size_t count);
+FNV_DEF uint64_t fnv1a_64_update(uint64_t out, const void* source, size_t count);
+
 // for correct work need open file with mode "rb"
 
 FNV_DEF uint32_t fnv1_32_file (FILE* file);
@@ -33,9 +42,22 @@ FNV_DEF uint64_t fnv1a_64_file(FILE* file);
 
 #ifdef FNV_IMPLEMENTATION
 
+#ifdef SOH_INSTRUMENT
+#include "../instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 uint32_t fnv1_32(const void* source, size_t count) {
+    return fnv1_32_update(FNV_32_OFFSET, source, count);
+}
+
+uint32_t fnv1_32_update(uint32_t out, const void* source, size_t count) {
     const uint8_t* data = (const uint8_t*)source;
-    uint32_t out = UINT32_C(0x811c9dc5);
     while (count --> 0) {
         out *= UINT32_C(0x1000193);
         out ^= *data++;
@@ -44,8 +66,11 @@ uint32_t fnv1_32(const void* source, size_t count) {
 }
 
 uint32_t fnv1a_32(const void* source, size_t count) {
+    return fnv1a_32_update(FNV_32_OFFSET, source, count);
+}
+
+uint32_t fnv1a_32_update(uint32_t out, const void* source, size_t count) {
     const uint8_t* data = (const uint8_t*)source;
-    uint32_t out = UINT32_C(0x811c9dc5);
     while (count --> 0) {
         out ^= *data++;
         out *= UINT32_C(0x1000193);
@@ -54,8 +79,11 @@ uint32_t fnv1a_32(const void* source, size_t count) {
 }
 
 uint64_t fnv1_64(const void* source, size_t count) {
+    return fnv1_64_update(FNV_64_OFFSET, source, count);
+}
+
+uint64_t fnv1_64_update(uint64_t out, const void* source, size_t count) {
     const uint8_t* data = (const uint8_t*)source;
-    uint64_t out = UINT64_C(0xcbf29ce484222325);
     while (count --> 0) {
         out *= UINT64_C(0x100000001b3);
         out ^= *data++;
@@ -64,8 +92,11 @@ uint64_t fnv1_64(const void* source, size_t count) {
 }
 
 uint64_t fnv1a_64(const void* source, size_t count) {
+    return fnv1a_64_update(FNV_64_OFFSET, source, count);
+}
+
+uint64_t fnv1a_64_update(uint64_t out, const void* source, size_t count) {
     const uint8_t* data = (const uint8_t*)source;
-    uint64_t out = UINT64_C(0xcbf29ce484222325);
     while (count --> 0) {
         out ^= *data++;
         out *= UINT64_C(0x100000001b3);
@@ -76,40 +107,52 @@ uint64_t fnv1a_64(const void* source, size_t count) {
 uint32_t fnv1_32_file(FILE* file) {
     int ch = 0;
     uint32_t out = UINT32_C(0x811c9dc5);
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_FNV_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out *= UINT32_C(0x1000193);
         out ^= (uint8_t)ch;
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
 uint32_t fnv1a_32_file(FILE* file) {
     int ch = 0;
     uint32_t out = UINT32_C(0x811c9dc5);
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_FNV_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out ^= (uint8_t)ch;
         out *= UINT32_C(0x1000193);
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
 uint64_t fnv1_64_file(FILE* file) {
     int ch = 0;
     uint64_t out = UINT64_C(0xcbf29ce484222325);
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_FNV_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out *= UINT64_C(0x100000001b3);
         out ^= (uint8_t)ch;
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
 uint64_t fnv1a_64_file(FILE* file) {
     int ch = 0;
     uint64_t out = UINT64_C(0xcbf29ce484222325);
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_FNV_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out ^= (uint8_t)ch;
         out *= UINT64_C(0x100000001b3);
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
@@ -0,0 +1,115 @@
+/*
+std::hash compatible hashers over hash/ kernels, C++14 and later
+
+siphash_hasher<Key> - SipHash-2-4 with random key drawn once
+                      per process from generate_seed_bytes,
+                      use for untrusted keys (hash flooding)
+fnv1a_hasher<Key>   - FNV-1a 64-bit, use for trusted keys
+
+Supported keys: integral, enum, pointer, floating point,
+std::basic_string and std::basic_string_view
+
+For linking need define in one translation unit:
+  SIPHASH_IMPLEMENTATION, FNV_IMPLEMENTATION, GEN_SEED_IMPLEMENTATION
+*/
+#ifndef HASHER_HPP
+#define HASHER_HPP
+
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef __cpp_lib_string_view
+#include <string_view>
+#endif
+
+#include "siphash.h"
+#include "fnv.h"
+#include "../gen_seed.h"
+
+namespace detail {
+
+// key as sequence of bytes passed to 'kernel(const void*, size_t)'
+template <typename Key, typename = void>
+struct hash_bytes; // unsupported key type
+
+template <typename Key>
+struct hash_bytes<Key, typename std::enable_if<
+    std::is_integral<Key>::value ||
+    std::is_enum<Key>::value ||
+    std::is_pointer<Key>::value
+>::type> {
+    template <typename Kernel>
+    static uint64_t apply(const Key& key, Kernel kernel) {
+        return kernel(&key, sizeof key);
+    }
+};
+
+template <typename Key>
+struct hash_bytes<Key, typename std::enable_if<
+    std::is_floating_point<Key>::value
+>::type> {
+    template <typename Kernel>
+    static uint64_t apply(const Key& key, Kernel kernel) {
+        const Key norm = key == Key(0) ? Key(0) : key; // -0.0 == 0.0
+        return kernel(&norm, sizeof norm);
+    }
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct hash_bytes<std::basic_string<CharT, Traits, Alloc>> {
+    template <typename Kernel>
+    static uint64_t apply(const std::basic_string<CharT, Traits, Alloc>& key, Kernel kernel) {
+        return kernel(key.data(), key.size() * sizeof(CharT));
+    }
+};
+
+#ifdef __cpp_lib_string_view
+template <typename CharT, typename Traits>
+struct hash_bytes<std::basic_string_view<CharT, Traits>> {
+    template <typename Kernel>
+    static uint64_t apply(const std::basic_string_view<CharT, Traits>& key, Kernel kernel) {
+        return kernel(key.data(), key.size() * sizeof(CharT));
+    }
+};
+#endif
+
+inline siphash_key_t process_siphash_key() {
+    static const siphash_key_t key = [] {
+        siphash_key_t out;
+        generate_seed_bytes(&out, sizeof out);
+        return out;
+    }();
+    return key;
+}
+
+} // namespace detail
+
+template <typename Key>
+struct siphash_hasher {
+    siphash_key_t key = detail::process_siphash_key();
+
+    siphash_hasher() = default;
+    explicit siphash_hasher(siphash_key_t k) noexcept : key(k) {}
+
+    size_t operator()(const Key& k) const noexcept {
+        const siphash_key_t sk = key;
+        return static_cast<size_t>(detail::hash_bytes<Key>::apply(k,
+            [sk](const void* data, size_t count) {
+                return siphash_2_4(sk, data, count);
+            }));
+    }
+};
+
+template <typename Key>
+struct fnv1a_hasher {
+    size_t operator()(const Key& k) const noexcept {
+        return static_cast<size_t>(detail::hash_bytes<Key>::apply(k,
+            [](const void* data, size_t count) {
+                return fnv1a_64(data, count);
+            }));
+    }
+};
+
+#endif // HASHER_HPP
@@ -26,6 +26,16 @@ PJW_DEF uint64_t pjw_64_file(FILE* file);
 
 #ifdef PJW_IMPLEMENTATION
 
+#ifdef SOH_INSTRUMENT
+#include "../instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 uint32_t pjw_32(const void* source, size_t count) {
     const uint8_t* data = (const uint8_t*)source;
     uint32_t out = 0, high;
@@ -55,26 +65,32 @@ uint64_t pjw_64(const void* source, size_t count) {
 uint32_t pjw_32_file(FILE* file) {
     int ch = 0;
     uint32_t out = 0, high;
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_PJW_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out = (out << 4) + (uint8_t)ch;
         if ((high = UINT32_C(0xF0000000) & out) != 0) {
             out ^= high >> 24;
             out &= ~high;
         }
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
 uint64_t pjw_64_file(FILE* file) {
     int ch = 0;
     uint64_t out = 0, high;
+    SOH_INSTR_BEGIN(instr, SOH_INSTR_PJW_FILE);
     while ((ch = fgetc(file)) != EOF) {
+        SOH_INSTR_BYTES(instr, 1);
         out = (out << 8) + (uint8_t)ch;
         if ((high = UINT64_C(0xFF00000000000000) & out) != 0) {
             out ^= high >> 48;
             out &= ~high;
         }
     }
+    SOH_INSTR_END(instr);
     return out;
 }
 
@@ -29,10 +29,22 @@ extern "C" {
 
 typedef struct { uint8_t value[32]; } sha256_hash_t;
 
+// streaming state, data may be given by parts of any size
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    size_t used; // bytes in 'block'
+} sha256_ctx_t;
+
 SHA256_DEF sha256_hash_t sha256(const void* source, size_t count);
 SHA256_DEF sha256_hash_t sha256_file(FILE* file);
 SHA256_DEF void sha256_put_hash(const sha256_hash_t* hash, FILE* file);
 
+SHA256_DEF void sha256_init(sha256_ctx_t* ctx);
+SHA256_DEF void sha256_update(sha256_ctx_t* ctx, const void* source, size_t count);
+SHA256_DEF sha256_hash_t sha256_final(sha256_ctx_t* ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +56,16 @@ SHA256_DEF void sha256_put_hash(const sha256_hash_t* hash, FILE* file);
 #include <stdbool.h>
 #include <string.h>
 
+#ifdef SOH_INSTRUMENT
+#include "../instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
 #define sha256_d_le2be_u64 sha256_d_le2be_u64_
 #define sha256_d_le2be_u32 sha256_d_le2be_u32_
@@ -104,10 +126,49 @@ size_t sha256_d_get_block(void* dbuf, size_t dbufe_sz, void** dof, size_t* count
     }
 }
 
+// 'w' contains block in first 16 words, rest is used as schedule
+void sha256_d_compress(uint32_t* hi, uint32_t* w) {
+    for (size_t i = 0; i < 16; i++)
+        w[i] = sha256_d_le2be_u32(w[i]);
+    for (size_t i = 16; i < 64; i++) {
+        uint32_t s0 = (w[i - 15] >> 3)
+            ^ sha256_d_rotr_u32(w[i - 15],  7)
+            ^ sha256_d_rotr_u32(w[i - 15], 18);
+        uint32_t s1 = (w[i - 2] >> 10)
+            ^ sha256_d_rotr_u32(w[i - 2], 17)
+            ^ sha256_d_rotr_u32(w[i - 2], 19);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a, b, c, d, e, f, g, h;
+    a = hi[0], b = hi[1], c = hi[2], d = hi[3],
+    e = hi[4], f = hi[5], g = hi[6], h = hi[7];
+    for (size_t i = 0; i < 64; i++) {
+        uint32_t choice = (e & f) ^ (~e & g);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t S0 =
+            sha256_d_rotr_u32(a,  2) ^
+            sha256_d_rotr_u32(a, 13) ^
+            sha256_d_rotr_u32(a, 22);
+        uint32_t S1 =
+            sha256_d_rotr_u32(e,  6) ^
+            sha256_d_rotr_u32(e, 11) ^
+            sha256_d_rotr_u32(e, 25);
+        uint32_t t1 = h + S1 + choice + sha256_d_k[i] + w[i];
+        uint32_t t2 = S0 + majority;
+
+        h = g; g = f; f = e; e =  d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    hi[0] += a, hi[1] += b, hi[2] += c, hi[3] += d,
+    hi[4] += e, hi[5] += f, hi[6] += g, hi[7] += h;
+}
+
 sha256_hash_t sha256_d_base(void* source, size_t count) {
     bool has_next_block     = true;
     bool need_paste_one_bit = true;
     size_t all_readed = 0;
+    SOH_INSTR_BEGIN(instr, count == (size_t)-1 ? SOH_INSTR_SHA256_FILE : SOH_INSTR_SHA256);
 
     uint32_t hi[8] = {
         0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
@@ -131,46 +192,15 @@ sha256_hash_t sha256_d_base(void* source, size_t count) {
             has_next_block = false;
         }
 
-        for (size_t i = 0; i < 16; i++)
-            w[i] = sha256_d_le2be_u32(w[i]);
-        for (size_t i = 16; i < 64; i++) {
-            uint32_t s0 = (w[i - 15] >> 3)
-                ^ sha256_d_rotr_u32(w[i - 15],  7)
-                ^ sha256_d_rotr_u32(w[i - 15], 18);
-            uint32_t s1 = (w[i - 2] >> 10)
-                ^ sha256_d_rotr_u32(w[i - 2], 17)
-                ^ sha256_d_rotr_u32(w[i - 2], 19);
-            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
-        }
-
-        uint32_t a, b, c, d, e, f, g, h;
-        a = hi[0], b = hi[1], c = hi[2], d = hi[3],
-        e = hi[4], f = hi[5], g = hi[6], h = hi[7];
-        for (size_t i = 0; i < 64; i++) {
-            uint32_t choice = (e & f) ^ (~e & g);
-            uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
-            uint32_t S0 =
-                sha256_d_rotr_u32(a,  2) ^
-                sha256_d_rotr_u32(a, 13) ^
-                sha256_d_rotr_u32(a, 22);
-            uint32_t S1 =
-                sha256_d_rotr_u32(e,  6) ^
-                sha256_d_rotr_u32(e, 11) ^
-                sha256_d_rotr_u32(e, 25);
-            uint32_t t1 = h + S1 + choice + sha256_d_k[i] + w[i];
-            uint32_t t2 = S0 + majority;
-
-            h = g; g = f; f = e; e =  d + t1;
-            d = c; c = b; b = a; a = t1 + t2;
-        }
-        hi[0] += a, hi[1] += b, hi[2] += c, hi[3] += d,
-        hi[4] += e, hi[5] += f, hi[6] += g, hi[7] += h;
+        sha256_d_compress(hi, w);
     }
 
     sha256_hash_t out = {0};
     for (size_t i = 0; i < 8; i++)
         hi[i] = sha256_d_le2be_u32(hi[i]);
     memcpy(out.value, hi, sizeof out);
+    SOH_INSTR_BYTES(instr, all_readed);
+    SOH_INSTR_END(instr);
     return out;
 }
 
@@ -182,6 +212,59 @@ sha256_hash_t sha256_file(FILE* file) {
     return sha256_d_base(file, -1);
 }
 
+void sha256_init(sha256_ctx_t* ctx) {
+    static const uint32_t h0[8] = {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+        0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+    };
+    memcpy(ctx->state, h0, sizeof h0);
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void sha256_update(sha256_ctx_t* ctx, const void* source, size_t count) {
+    const uint8_t* data = (const uint8_t*)source;
+    uint32_t w[64];
+    ctx->length += count;
+    if (ctx->used > 0) {
+        size_t take = 64 - ctx->used < count ? 64 - ctx->used : count;
+        memcpy(ctx->block + ctx->used, data, take);
+        ctx->used += take;
+        data += take;
+        count -= take;
+        if (ctx->used < 64)
+            return;
+        memcpy(w, ctx->block, 64);
+        sha256_d_compress(ctx->state, w);
+        ctx->used = 0;
+    }
+    for (; count >= 64; data += 64, count -= 64) {
+        memcpy(w, data, 64);
+        sha256_d_compress(ctx->state, w);
+    }
+    memcpy(ctx->block, data, count);
+    ctx->used = count;
+}
+
+sha256_hash_t sha256_final(sha256_ctx_t* ctx) {
+    uint32_t w[64] = {0};
+    uint8_t* chunk = (uint8_t*)w;
+    memcpy(chunk, ctx->block, ctx->used);
+    chunk[ctx->used] = 0x80;
+    if (ctx->used >= 56) {
+        sha256_d_compress(ctx->state, w);
+        memset(w, 0, sizeof w);
+    }
+    *(uint64_t*)(chunk + 56) = sha256_d_le2be_u64(ctx->length * 8);
+    sha256_d_compress(ctx->state, w);
+
+    sha256_hash_t out = {0};
+    for (size_t i = 0; i < 8; i++)
+        ctx->state[i] = sha256_d_le2be_u32(ctx->state[i]);
+    memcpy(out.value, ctx->state, sizeof out);
+    return out;
+}
+
 void sha256_put_hash(const sha256_hash_t* hash, FILE* file) {
     for (size_t i = 0; i < 32; i++)
         fprintf(file, "%02hhx", hash->value[i]);
@@ -18,6 +18,15 @@ typedef struct {
     uint64_t high;
 } siphash_key_t;
 
+// streaming state, data may be given by parts of any size
+typedef struct {
+    uint64_t v0, v1, v2, v3;
+    size_t c, d;
+    uint64_t length;
+    uint8_t block[8];
+    size_t used; // bytes in 'block'
+} siphash_ctx_t;
+
 SIPHASH_DEF uint64_t siphash(
     size_t c, size_t d, siphash_key_t key,
     const void* source, size_t count);
@@ -29,6 +38,12 @@ SIPHASH_DEF uint64_t siphash_file(
 SIPHASH_DEF uint64_t siphash_2_4_file(
     siphash_key_t key, FILE* file);
 
+SIPHASH_DEF void siphash_init(siphash_ctx_t* ctx,
+    size_t c, size_t d, siphash_key_t key);
+SIPHASH_DEF void siphash_update(siphash_ctx_t* ctx,
+    const void* source, size_t count);
+SIPHASH_DEF uint64_t siphash_final(siphash_ctx_t* ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +55,16 @@ SIPHASH_DEF uint64_t siphash_2_4_file(
 #include <stdbool.h>
 #include <string.h>
 
+#ifdef SOH_INSTRUMENT
+#include "../instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 void siphash_d_rotl(uint64_t* n, uint8_t shift) {
     *n = (*n << shift) | (*n >> (64 - shift));
 }
@@ -83,6 +108,7 @@ uint64_t siphash_d_base(
 ) {
     bool has_next_block = true;
     uint64_t all_readed = 0;
+    SOH_INSTR_BEGIN(instr, count == (size_t)-1 ? SOH_INSTR_SIPHASH_FILE : SOH_INSTR_SIPHASH);
 
     uint64_t v0 = key.low  ^ UINT64_C(0x736f6d6570736575);
     uint64_t v1 = key.high ^ UINT64_C(0x646f72616e646f6d);
@@ -109,6 +135,8 @@ uint64_t siphash_d_base(
     for (size_t i = 0; i < d; i++)
         siphash_d_round(&v0, &v1, &v2, &v3);
 
+    SOH_INSTR_BYTES(instr, all_readed);
+    SOH_INSTR_END(instr);
     return v0 ^ v1 ^ v2 ^ v3;
 }
 
@@ -129,4 +157,59 @@ uint64_t siphash_2_4_file(siphash_key_t key, FILE* file) {
     return siphash_d_base(2, 4, key, file, -1);
 }
 
+void siphash_d_compress(siphash_ctx_t* ctx, uint64_t mi) {
+    ctx->v3 ^= mi;
+    for (size_t i = 0; i < ctx->c; i++)
+        siphash_d_round(&ctx->v0, &ctx->v1, &ctx->v2, &ctx->v3);
+    ctx->v0 ^= mi;
+}
+
+void siphash_init(siphash_ctx_t* ctx, size_t c, size_t d, siphash_key_t key) {
+    ctx->v0 = key.low  ^ UINT64_C(0x736f6d6570736575);
+    ctx->v1 = key.high ^ UINT64_C(0x646f72616e646f6d);
+    ctx->v2 = key.low  ^ UINT64_C(0x6c7967656e657261);
+    ctx->v3 = key.high ^ UINT64_C(0x7465646279746573);
+    ctx->c = c;
+    ctx->d = d;
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void siphash_update(siphash_ctx_t* ctx, const void* source, size_t count) {
+    const uint8_t* data = (const uint8_t*)source;
+    uint64_t mi;
+    ctx->length += count;
+    if (ctx->used > 0) {
+        size_t take = 8 - ctx->used < count ? 8 - ctx->used : count;
+        memcpy(ctx->block + ctx->used, data, take);
+        ctx->used += take;
+        data += take;
+        count -= take;
+        if (ctx->used < 8)
+            return;
+        memcpy(&mi, ctx->block, 8);
+        siphash_d_compress(ctx, mi);
+        ctx->used = 0;
+    }
+    for (; count >= 8; data += 8, count -= 8) {
+        memcpy(&mi, data, 8);
+        siphash_d_compress(ctx, mi);
+    }
+    memcpy(ctx->block, data, count);
+    ctx->used = count;
+}
+
+uint64_t siphash_final(siphash_ctx_t* ctx) {
+    uint64_t mi = 0;
+    memcpy(&mi, ctx->block, ctx->used);
+    mi |= (ctx->length & 255) << 56;
+    siphash_d_compress(ctx, mi);
+
+    ctx->v2 ^= 0xff;
+    for (size_t i = 0; i < ctx->d; i++)
+        siphash_d_round(&ctx->v0, &ctx->v1, &ctx->v2, &ctx->v3);
+
+    return ctx->v0 ^ ctx->v1 ^ ctx->v2 ^ ctx->v3;
+}
+
 #endif // SIPHASH_IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,503 @@
+/* HyperLogLog++ cardinality estimator in C over fnv1a_64 or siphash_2_4 */
+/*
+Register index is top p bits of 64-bit hash (4 <= p <= 18),
+relative error is about 1.04 / sqrt(2^p): 1.6% for p = 12 (4 KiB)
+
+Representations:
+  sparse - set of (25-bit index, rank) pairs in open-addressing table,
+           exact for small cardinality (linear counting with 2^25 buckets),
+           becomes dense once it would use more memory than dense
+  dense  - 2^p one-byte registers, estimate by improved raw estimator
+           (O. Ertl, 2017), no empirical bias tables needed
+
+Sketches with equal p and hash are mergeable (per thread or per node),
+merge of sparse into dense and sparse into sparse is supported
+
+Serialized format (host byte order):
+  offset  size  field
+       0     4  magic "SHLL"
+       4     1  version = 1
+       5     1  p
+       6     1  format: 0 - sparse, 1 - dense
+       7     1  hash kind
+       8    16  siphash key (low, high)
+      24     4  count of sparse entries (0 for dense)
+      28   ...  sparse: sorted entries as LEB128 deltas,
+                dense: registers packed by 6 bits, low bits first
+
+For linking need define in one translation unit:
+  HYPERLOGLOG_IMPLEMENTATION, SIPHASH_IMPLEMENTATION, FNV_IMPLEMENTATION
+*/
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "hash/siphash.h"
+#include "hash/fnv.h"
+
+#ifndef HLL_DEF
+#define HLL_DEF
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HLL_HASH_FNV1A_64    = 0,
+    HLL_HASH_SIPHASH_2_4 = 1
+} hll_hash_kind;
+
+typedef struct {
+    uint8_t p;
+    uint8_t hash_kind;
+    uint8_t is_sparse;
+    siphash_key_t key;        // used with HLL_HASH_SIPHASH_2_4
+    uint8_t* registers;       // dense: 2^p registers
+    uint32_t* sparse;         // sparse: index << 6 | rank, 0 is free slot
+    uint32_t sparse_count;
+    uint32_t sparse_capacity; // power of 2
+} hll_t;
+
+// all functions returning int give 0 on success and -1 on error
+
+HLL_DEF int  hll_init(hll_t* hll, unsigned p, hll_hash_kind kind, siphash_key_t key);
+HLL_DEF void hll_free(hll_t* hll);
+HLL_DEF void hll_clear(hll_t* hll);
+
+HLL_DEF uint64_t hll_hash(const hll_t* hll, const void* source, size_t count);
+HLL_DEF int hll_add_hash(hll_t* hll, uint64_t hash);
+HLL_DEF int hll_add(hll_t* hll, const void* source, size_t count);
+
+HLL_DEF int hll_add_hashes(hll_t* hll, const uint64_t* hashes, size_t n);
+// keys[i] with length counts[i]
+HLL_DEF int hll_add_batch(hll_t* hll,
+    const void* const* keys, const size_t* counts, size_t n);
+
+HLL_DEF double hll_estimate(const hll_t* hll);
+HLL_DEF int hll_merge(hll_t* dst, const hll_t* src);
+
+// upper bound for hll_serialize output
+HLL_DEF size_t hll_serialized_bound(const hll_t* hll);
+// returns count of written bytes or 0 if 'size' is too small
+HLL_DEF size_t hll_serialize(const hll_t* hll, void* buffer, size_t size);
+HLL_DEF int hll_deserialize(hll_t* hll, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HYPERLOGLOG_H
+
+#ifdef HYPERLOGLOG_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HLL_D_SPARSE_P      25
+#define HLL_D_HEADER_BYTES  28
+#define HLL_D_VERSION       1
+#define HLL_D_MIN_CAPACITY  16
+
+const char hll_d_magic[4] = {'S', 'H', 'L', 'L'};
+
+unsigned hll_d_clz64(uint64_t n) { // n != 0
+#if defined(__GNUC__)
+    return (unsigned)__builtin_clzll(n);
+#else
+    unsigned out = 0;
+    for (; !(n & UINT64_C(0x8000000000000000)); n <<= 1) out++;
+    return out;
+#endif
+}
+
+uint32_t hll_d_sparse_encode(uint64_t hash) {
+    const uint32_t index = (uint32_t)(hash >> (64 - HLL_D_SPARSE_P));
+    const uint64_t rest  = (hash << HLL_D_SPARSE_P) | (UINT64_C(1) << (HLL_D_SPARSE_P - 1));
+    return index << 6 | (hll_d_clz64(rest) + 1);
+}
+
+void hll_d_sparse_decode(uint32_t entry, unsigned p, uint32_t* index, uint8_t* rank) {
+    const unsigned extra = HLL_D_SPARSE_P - p;
+    const uint32_t sindex = entry >> 6;
+    const uint32_t low = sindex & ((UINT32_C(1) << extra) - 1);
+    *index = sindex >> extra;
+    if (low != 0)
+        *rank = (uint8_t)(hll_d_clz64((uint64_t)low << (64 - extra)) + 1);
+    else
+        *rank = (uint8_t)(extra + (entry & 63));
+}
+
+uint32_t hll_d_slot(uint32_t sindex, uint32_t capacity) {
+    return (sindex * UINT32_C(0x9e3779b1)) >> 7 & (capacity - 1);
+}
+
+// insert without growth, keeps max rank for equal index
+void hll_d_sparse_put(uint32_t* table, uint32_t capacity, uint32_t* count, uint32_t entry) {
+    const uint32_t sindex = entry >> 6;
+    for (uint32_t i = hll_d_slot(sindex, capacity);; i = (i + 1) & (capacity - 1)) {
+        if (table[i] == 0) {
+            table[i] = entry;
+            ++*count;
+            return;
+        }
+        if (table[i] >> 6 == sindex) {
+            if ((entry & 63) > (table[i] & 63))
+                table[i] = entry;
+            return;
+        }
+    }
+}
+
+int hll_d_to_dense(hll_t* hll) {
+    if (!hll->is_sparse) return 0;
+    const size_t m = (size_t)1 << hll->p;
+    uint8_t* registers = (uint8_t*)calloc(m, 1);
+    if (!registers) return -1;
+
+    for (uint32_t i = 0; i < hll->sparse_capacity; i++) {
+        if (hll->sparse[i] == 0) continue;
+        uint32_t index;
+        uint8_t rank;
+        hll_d_sparse_decode(hll->sparse[i], hll->p, &index, &rank);
+        if (rank > registers[index]) registers[index] = rank;
+    }
+
+    free(hll->sparse);
+    hll->sparse = NULL;
+    hll->sparse_count = hll->sparse_capacity = 0;
+    hll->registers = registers;
+    hll->is_sparse = 0;
+    return 0;
+}
+
+// grow sparse table or switch to dense if table outgrows registers
+int hll_d_reserve(hll_t* hll, uint32_t count) {
+    if (!hll->is_sparse) return 0;
+    const size_t dense_bytes = (size_t)1 << hll->p;
+    if ((size_t)count * 2 * sizeof(uint32_t) > dense_bytes)
+        return hll_d_to_dense(hll);
+
+    uint32_t capacity = hll->sparse_capacity;
+    while (count * 2 > capacity) capacity *= 2;
+    if (capacity == hll->sparse_capacity) return 0;
+    if ((size_t)capacity * sizeof(uint32_t) > dense_bytes)
+        return hll_d_to_dense(hll);
+
+    uint32_t* table = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    if (!table) return -1;
+    uint32_t new_count = 0;
+    for (uint32_t i = 0; i < hll->sparse_capacity; i++)
+        if (hll->sparse[i] != 0)
+            hll_d_sparse_put(table, capacity, &new_count, hll->sparse[i]);
+
+    free(hll->sparse);
+    hll->sparse = table;
+    hll->sparse_capacity = capacity;
+    return 0;
+}
+
+int hll_init(hll_t* hll, unsigned p, hll_hash_kind kind, siphash_key_t key) {
+    memset(hll, 0, sizeof *hll);
+    if (p < 4 || p > 18 || (unsigned)kind > HLL_HASH_SIPHASH_2_4) return -1;
+    hll->p = (uint8_t)p;
+    hll->hash_kind = (uint8_t)kind;
+    hll->key = key;
+    hll->is_sparse = 1;
+    hll->sparse = (uint32_t*)calloc(HLL_D_MIN_CAPACITY, sizeof(uint32_t));
+    if (!hll->sparse) return -1;
+    hll->sparse_capacity = HLL_D_MIN_CAPACITY;
+    if (HLL_D_MIN_CAPACITY * sizeof(uint32_t) > ((size_t)1 << p))
+        return hll_d_to_dense(hll);
+    return 0;
+}
+
+void hll_free(hll_t* hll) {
+    free(hll->registers);
+    free(hll->sparse);
+    memset(hll, 0, sizeof *hll);
+}
+
+void hll_clear(hll_t* hll) {
+    if (hll->is_sparse) {
+        memset(hll->sparse, 0, hll->sparse_capacity * sizeof(uint32_t));
+        hll->sparse_count = 0;
+    } else {
+        memset(hll->registers, 0, (size_t)1 << hll->p);
+    }
+}
+
+uint64_t hll_hash(const hll_t* hll, const void* source, size_t count) {
+    if (hll->hash_kind == HLL_HASH_SIPHASH_2_4)
+        return siphash_2_4(hll->key, source, count);
+    // last bytes of key barely reach high bits of fnv1a_64
+    uint64_t h = fnv1a_64(source, count);
+    h = (h ^ (h >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+    h = (h ^ (h >> 33)) * UINT64_C(0xc4ceb9fe1a85ec53);
+    return h ^ (h >> 33);
+}
+
+int hll_add_hash(hll_t* hll, uint64_t hash) {
+    if (hll->is_sparse) {
+        if (hll_d_reserve(hll, hll->sparse_count + 1) != 0)
+            return -1;
+        if (hll->is_sparse) {
+            hll_d_sparse_put(hll->sparse, hll->sparse_capacity,
+                &hll->sparse_count, hll_d_sparse_encode(hash));
+            return 0;
+        }
+    }
+    const uint32_t index = (uint32_t)(hash >> (64 - hll->p));
+    const uint64_t rest  = (hash << hll->p) | (UINT64_C(1) << (hll->p - 1));
+    const uint8_t rank   = (uint8_t)(hll_d_clz64(rest) + 1);
+    if (rank > hll->registers[index])
+        hll->registers[index] = rank;
+    return 0;
+}
+
+int hll_add(hll_t* hll, const void* source, size_t count) {
+    return hll_add_hash(hll, hll_hash(hll, source, count));
+}
+
+int hll_add_hashes(hll_t* hll, const uint64_t* hashes, size_t n) {
+    size_t i = 0;
+    // sparse part goes one by one, it can switch to dense
+    for (; i < n && hll->is_sparse; i++)
+        if (hll_add_hash(hll, hashes[i]) != 0)
+            return -1;
+
+    const unsigned p = hll->p;
+    uint8_t* registers = hll->registers;
+    for (; i < n; i++) {
+        const uint32_t index = (uint32_t)(hashes[i] >> (64 - p));
+        const uint64_t rest  = (hashes[i] << p) | (UINT64_C(1) << (p - 1));
+        const uint8_t rank   = (uint8_t)(hll_d_clz64(rest) + 1);
+        if (rank > registers[index])
+            registers[index] = rank;
+    }
+    return 0;
+}
+
+int hll_add_batch(hll_t* hll,
+    const void* const* keys, const size_t* counts, size_t n) {
+    uint64_t hashes[64];
+    while (n > 0) {
+        const size_t m = n < 64 ? n : 64;
+        for (size_t i = 0; i < m; i++)
+            hashes[i] = hll_hash(hll, keys[i], counts[i]);
+        if (hll_add_hashes(hll, hashes, m) != 0)
+            return -1;
+        keys += m, counts += m, n -= m;
+    }
+    return 0;
+}
+
+double hll_d_sigma(double x) {
+    if (x == 1) return INFINITY;
+    double y = 1, z = x, prev;
+    do {
+        x *= x;
+        prev = z;
+        z += x * y;
+        y += y;
+    } while (z != prev);
+    return z;
+}
+
+double hll_d_tau(double x) {
+    if (x == 0 || x == 1) return 0;
+    double y = 1, z = 1 - x, prev;
+    do {
+        x = sqrt(x);
+        prev = z;
+        y *= 0.5;
+        z -= (1 - x) * (1 - x) * y;
+    } while (z != prev);
+    return z / 3;
+}
+
+double hll_estimate(const hll_t* hll) {
+    if (hll->is_sparse) {
+        const double m = (double)(UINT32_C(1) << HLL_D_SPARSE_P);
+        return m * log(m / (m - (double)hll->sparse_count));
+    }
+
+    const size_t m = (size_t)1 << hll->p;
+    const unsigned q = 64 - hll->p;
+    uint32_t hist[66] = {0};
+    for (size_t i = 0; i < m; i++)
+        hist[hll->registers[i]]++;
+
+    const double dm = (double)m;
+    double z = dm * hll_d_tau(1 - hist[q + 1] / dm);
+    for (unsigned k = q; k >= 1; k--)
+        z = 0.5 * (z + hist[k]);
+    z += dm * hll_d_sigma(hist[0] / dm);
+    return dm * dm / (2 * log(2.0)) / z;
+}
+
+int hll_merge(hll_t* dst, const hll_t* src) {
+    if (dst->p != src->p || dst->hash_kind != src->hash_kind ||
+        dst->key.low != src->key.low || dst->key.high != src->key.high)
+        return -1;
+
+    if (src->is_sparse) {
+        if (dst->is_sparse && hll_d_reserve(dst, dst->sparse_count + src->sparse_count) != 0)
+            return -1;
+        for (uint32_t i = 0; i < src->sparse_capacity; i++) {
+            const uint32_t entry = src->sparse[i];
+            if (entry == 0) continue;
+            if (dst->is_sparse) {
+                hll_d_sparse_put(dst->sparse, dst->sparse_capacity, &dst->sparse_count, entry);
+            } else {
+                uint32_t index;
+                uint8_t rank;
+                hll_d_sparse_decode(entry, dst->p, &index, &rank);
+                if (rank > dst->registers[index]) dst->registers[index] = rank;
+            }
+        }
+        return 0;
+    }
+
+    if (dst->is_sparse && hll_d_to_dense(dst) != 0)
+        return -1;
+    const size_t m = (size_t)1 << dst->p;
+    for (size_t i = 0; i < m; i++)
+        if (src->registers[i] > dst->registers[i])
+            dst->registers[i] = src->registers[i];
+    return 0;
+}
+
+int hll_d_compare_u32(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+size_t hll_serialized_bound(const hll_t* hll) {
+    if (hll->is_sparse)
+        return HLL_D_HEADER_BYTES + (size_t)hll->sparse_count * 5;
+    return HLL_D_HEADER_BYTES + ((((size_t)1 << hll->p) * 6 + 7) / 8);
+}
+
+size_t hll_serialize(const hll_t* hll, void* buffer, size_t size) {
+    uint8_t* out = (uint8_t*)buffer;
+    const uint32_t count = hll->is_sparse ? hll->sparse_count : 0;
+    if (size < HLL_D_HEADER_BYTES) return 0;
+
+    memcpy(out, hll_d_magic, 4);
+    out[4] = HLL_D_VERSION;
+    out[5] = hll->p;
+    out[6] = hll->is_sparse ? 0 : 1;
+    out[7] = hll->hash_kind;
+    memcpy(out +  8, &hll->key.low, 8);
+    memcpy(out + 16, &hll->key.high, 8);
+    memcpy(out + 24, &count, 4);
+    size_t pos = HLL_D_HEADER_BYTES;
+
+    if (hll->is_sparse) {
+        uint32_t* sorted = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+        if (!sorted) return 0;
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < hll->sparse_capacity; i++)
+            if (hll->sparse[i] != 0) sorted[n++] = hll->sparse[i];
+        qsort(sorted, n, sizeof(uint32_t), hll_d_compare_u32);
+
+        uint32_t prev = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t delta = sorted[i] - prev;
+            prev = sorted[i];
+            do {
+                if (pos == size) { free(sorted); return 0; }
+                out[pos++] = (uint8_t)((delta & 0x7f) | (delta > 0x7f ? 0x80 : 0));
+                delta >>= 7;
+            } while (delta);
+        }
+        free(sorted);
+        return pos;
+    }
+
+    const size_t m = (size_t)1 << hll->p;
+    const size_t packed = (m * 6 + 7) / 8;
+    if (size - pos < packed) return 0;
+    memset(out + pos, 0, packed);
+    for (size_t i = 0; i < m; i++) {
+        const size_t bit = i * 6;
+        const unsigned value = hll->registers[i] & 63;
+        out[pos + bit / 8] |= (uint8_t)(value << (bit % 8));
+        if (bit % 8 > 2)
+            out[pos + bit / 8 + 1] |= (uint8_t)(value >> (8 - bit % 8));
+    }
+    return pos + packed;
+}
+
+int hll_d_sparse_read(hll_t* hll, const uint8_t* in, size_t size, uint32_t count) {
+    if (hll_d_reserve(hll, count) != 0) return -1;
+    size_t pos = 0;
+    uint32_t entry = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t delta = 0;
+        unsigned shift = 0;
+        uint8_t byte;
+        do {
+            if (pos == size || shift > 28) return -1;
+            byte = in[pos++];
+            delta |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        entry += delta;
+        if ((entry & 63) == 0) return -1;
+
+        if (hll->is_sparse) {
+            hll_d_sparse_put(hll->sparse, hll->sparse_capacity, &hll->sparse_count, entry);
+        } else {
+            uint32_t index;
+            uint8_t rank;
+            hll_d_sparse_decode(entry, hll->p, &index, &rank);
+            if (rank > hll->registers[index]) hll->registers[index] = rank;
+        }
+    }
+    return 0;
+}
+
+int hll_deserialize(hll_t* hll, const void* buffer, size_t size) {
+    const uint8_t* in = (const uint8_t*)buffer;
+    if (size < HLL_D_HEADER_BYTES || memcmp(in, hll_d_magic, 4) != 0 ||
+        in[4] != HLL_D_VERSION || in[6] > 1 || in[7] > HLL_HASH_SIPHASH_2_4)
+        return -1;
+
+    siphash_key_t key;
+    uint32_t count;
+    memcpy(&key.low,  in +  8, 8);
+    memcpy(&key.high, in + 16, 8);
+    memcpy(&count, in + 24, 4);
+    if (hll_init(hll, in[5], (hll_hash_kind)in[7], key) != 0)
+        return -1;
+    size_t pos = HLL_D_HEADER_BYTES;
+
+    if (in[6] == 0) {
+        if (hll_d_sparse_read(hll, in + pos, size - pos, count) != 0) {
+            hll_free(hll);
+            return -1;
+        }
+        return 0;
+    }
+
+    const size_t m = (size_t)1 << hll->p;
+    if (size - pos < (m * 6 + 7) / 8 || (hll->is_sparse && hll_d_to_dense(hll) != 0)) {
+        hll_free(hll);
+        return -1;
+    }
+    for (size_t i = 0; i < m; i++) {
+        const size_t bit = i * 6;
+        unsigned value = in[pos + bit / 8] >> (bit % 8);
+        if (bit % 8 > 2)
+            value |= (unsigned)in[pos + bit / 8 + 1] << (8 - bit % 8);
+        hll->registers[i] = (uint8_t)(value & 63);
+    }
+    return 0;
+}
+
+#endif // HYPERLOGLOG_IMPLEMENTATION
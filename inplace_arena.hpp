@@ -0,0 +1,264 @@
+/* Inplace monotonic arena and object pool in C++14 and later, std::pmr resource since C++17 */
+/*
+  inplace_arena<4096> arena;                    // std::pmr::memory_resource if available
+  std::pmr::vector<int> v(&arena);              // C++17
+  std::vector<int, arena_allocator<int, inplace_arena<4096>>> w(arena); // C++14
+  arena.reset();                                // O(1) if upstream was not used
+
+  inplace_object_pool<node, 64> pool;
+  node* n = pool.create(args...);
+  pool.destroy(n);
+
+inplace_arena carves memory from inline buffer by pointer bump, after it
+is exhausted takes blocks of growing size from upstream (default resource
+or ::operator new). deallocate does nothing, memory is returned by reset.
+inplace_object_pool keeps N slots inline, free slots are linked in list
+stored in slots themselves.
+*/
+#ifndef INPLACE_ARENA_HPP
+#define INPLACE_ARENA_HPP
+
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
+#ifdef __cpp_lib_memory_resource
+#define INPLACE_ARENA_PMR 1
+#endif
+
+template <size_t N>
+class inplace_arena
+#ifdef INPLACE_ARENA_PMR
+    : public std::pmr::memory_resource
+#endif
+{
+    static_assert(N > 0, "Size of inplace_arena must be positive");
+
+public:
+#ifdef INPLACE_ARENA_PMR
+    explicit inplace_arena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+    : m_upstream(upstream) {}
+#else
+    inplace_arena() = default;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) { return bump(bytes, align); }
+    void deallocate(void*, size_t, size_t = alignof(std::max_align_t)) noexcept {}
+#endif
+    ~inplace_arena() { release_upstream(); }
+
+    inplace_arena(const inplace_arena&) = delete;
+    inplace_arena& operator=(const inplace_arena&) = delete;
+
+    // all allocated memory becomes free, upstream blocks are returned
+    void reset() noexcept {
+        release_upstream();
+        m_cur = m_data;
+        m_end = m_data + N;
+    }
+
+    // bytes used in inline buffer, counts alignment padding
+    size_t inline_used() const noexcept {
+        return m_blocks ? N : static_cast<size_t>(m_cur - m_data);
+    }
+    size_t upstream_blocks() const noexcept { return m_block_count; }
+    static constexpr size_t inline_capacity() noexcept { return N; }
+
+private:
+    struct block_t {
+        block_t* next;
+        size_t size; // with header
+    };
+
+    void* bump(size_t bytes, size_t align) {
+        if (void* p = take(bytes, align))
+            return p;
+        grow(bytes, align);
+        if (void* p = take(bytes, align))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void* take(size_t bytes, size_t align) noexcept {
+        const uintptr_t cur = reinterpret_cast<uintptr_t>(m_cur);
+        const uintptr_t aligned = (cur + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        if (aligned < cur || aligned - cur > static_cast<size_t>(m_end - m_cur)
+            || bytes > static_cast<size_t>(m_end - m_cur) - (aligned - cur))
+            return nullptr;
+        m_cur += (aligned - cur) + bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void grow(size_t bytes, size_t align) {
+        if (bytes > size_t(-1) - sizeof(block_t) - align)
+            throw std::bad_alloc();
+        const size_t last = m_blocks ? m_blocks->size : N;
+        size_t size = sizeof(block_t) + bytes + align;
+        if (last <= size_t(-1) / 2 && size < last * 2) size = last * 2;
+
+        block_t* block = static_cast<block_t*>(upstream_allocate(size));
+        block->next = m_blocks;
+        block->size = size;
+        m_blocks = block;
+        m_block_count++;
+        m_cur = reinterpret_cast<char*>(block + 1);
+        m_end = reinterpret_cast<char*>(block) + size;
+    }
+
+    void release_upstream() noexcept {
+        while (m_blocks) {
+            block_t* next = m_blocks->next;
+            upstream_deallocate(m_blocks, m_blocks->size);
+            m_blocks = next;
+        }
+        m_block_count = 0;
+    }
+
+#ifdef INPLACE_ARENA_PMR
+    void* do_allocate(size_t bytes, size_t align) override { return bump(bytes, align); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void* upstream_allocate(size_t size) { return m_upstream->allocate(size, alignof(block_t)); }
+    void upstream_deallocate(void* p, size_t size) noexcept { m_upstream->deallocate(p, size, alignof(block_t)); }
+#else
+    static void* upstream_allocate(size_t size) { return ::operator new(size); }
+    static void upstream_deallocate(void* p, size_t) noexcept { ::operator delete(p); }
+#endif
+
+private:
+    alignas(std::max_align_t) char m_data[N];
+    char* m_cur = m_data;
+    char* m_end = m_data + N;
+    block_t* m_blocks = nullptr;
+    size_t m_block_count = 0;
+#ifdef INPLACE_ARENA_PMR
+    std::pmr::memory_resource* m_upstream;
+#endif
+};
+
+// Allocator for standard containers over arena with allocate(bytes, align)
+template <typename T, typename Arena>
+class arena_allocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = arena_allocator<U, Arena>; };
+
+public:
+    arena_allocator(Arena& arena) noexcept : m_arena(&arena) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U, Arena>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(size_t count) {
+        if (count > size_t(-1) / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t count) noexcept {
+        m_arena->deallocate(p, count * sizeof(T), alignof(T));
+    }
+
+    Arena* arena() const noexcept { return m_arena; }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U, Arena>& rhs) const noexcept { return m_arena == rhs.arena(); }
+    template <typename U>
+    bool operator!=(const arena_allocator<U, Arena>& rhs) const noexcept { return m_arena != rhs.arena(); }
+
+private:
+    Arena* m_arena;
+};
+
+template <typename T, size_t N>
+class inplace_object_pool {
+    static_assert(N > 0, "Size of inplace_object_pool must be positive");
+
+public:
+    using value_type = T;
+    using pointer    = T*;
+
+public:
+    inplace_object_pool() = default;
+    inplace_object_pool(const inplace_object_pool&) = delete;
+    inplace_object_pool& operator=(const inplace_object_pool&) = delete;
+
+    // nullptr if all slots are used
+    template <typename... Args>
+    pointer try_create(Args&&... args) {
+        slot_t* slot = take();
+        if (!slot) return nullptr;
+        try {
+            return new (slot->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            give(slot);
+            throw;
+        }
+    }
+    template <typename... Args>
+    pointer create(Args&&... args) {
+        if (pointer p = try_create(std::forward<Args>(args)...))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    // 'p' must be created by this pool
+    void destroy(pointer p) noexcept {
+        if (!p) return;
+        p->~T();
+        give(reinterpret_cast<slot_t*>(p));
+    }
+
+    // all slots become free in O(1), destructors of live objects are not called
+    void reset() noexcept {
+        m_free = nullptr;
+        m_fresh = 0;
+        m_live = 0;
+    }
+
+    bool owns(const T* p) const noexcept {
+        const char* c = reinterpret_cast<const char*>(p);
+        const char* begin = reinterpret_cast<const char*>(m_slots);
+        return c >= begin && c < begin + sizeof m_slots;
+    }
+
+    size_t size() const noexcept { return m_live; }
+    bool full() const noexcept { return m_live == N; }
+    static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    union slot_t {
+        slot_t* next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    slot_t* take() noexcept {
+        slot_t* slot = m_free;
+        if (slot) m_free = slot->next;
+        else if (m_fresh < N) slot = &m_slots[m_fresh++]; // never used slots need no list
+        else return nullptr;
+        m_live++;
+        return slot;
+    }
+    void give(slot_t* slot) noexcept {
+        slot->next = m_free;
+        m_free = slot;
+        m_live--;
+    }
+
+private:
+    slot_t m_slots[N];
+    slot_t* m_free = nullptr;
+    size_t m_fresh = 0;
+    size_t m_live = 0;
+};
+
+#endif // INPLACE_ARENA_HPP
@@ -0,0 +1,110 @@
+/* Inplace bounded work-stealing deque in C++14 and later */
+/*
+Chase-Lev deque with fixed capacity (N. M. Le et al., "Correct and
+Efficient Work-Stealing for Weak Memory Models", 2013):
+  owner thread    - try_push / try_pop at bottom, LIFO like inplace_stack
+  other threads   - try_steal at top, FIFO
+
+Storage is inline, no allocation and no resize. T must be trivially
+copyable, elements are kept in atomics because thief can read cell while
+owner writes it (thief then fails its CAS and drops the value).
+Usually T is pointer to task.
+*/
+#ifndef INPLACE_DEQUE_HPP
+#define INPLACE_DEQUE_HPP
+
+#include <type_traits>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace impl {
+
+template <typename T, size_t N>
+class Inplace_ws_deque {
+    static_assert(N > 0, "Capacity of Inplace_ws_deque must be positive");
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Inplace_ws_deque needs trivially copyable T, store pointers for other types");
+
+    using index_t = std::ptrdiff_t;
+
+public:
+    using value_type = T;
+
+public:
+    Inplace_ws_deque() = default;
+    Inplace_ws_deque(const Inplace_ws_deque&) = delete;
+    Inplace_ws_deque& operator=(const Inplace_ws_deque&) = delete;
+
+    // owner only, false if full
+    bool try_push(T new_value) noexcept {
+        const index_t b = m_bottom.load(std::memory_order_relaxed);
+        const index_t t = m_top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<index_t>(N))
+            return false;
+        cell(b).store(new_value, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_release); // publishes cell to thieves
+        return true;
+    }
+
+    // owner only, takes last pushed element
+    bool try_pop(T& out) noexcept {
+        const index_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        index_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b) { // empty
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = cell(b).load(std::memory_order_relaxed);
+        if (t == b) { // last element, race with thieves
+            const bool won = m_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // any thread, takes first pushed element, false if empty or lost race
+    bool try_steal(T& out) noexcept {
+        index_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const index_t b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+        const T value = cell(t).load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+        out = value;
+        return true;
+    }
+
+    size_t size_approx() const noexcept {
+        const index_t b = m_bottom.load(std::memory_order_relaxed);
+        const index_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    std::atomic<T>& cell(index_t index) noexcept {
+        return m_cells[static_cast<size_t>(index) % N];
+    }
+
+private:
+    alignas(64) std::atomic<index_t> m_top {0};    // stolen from here
+    alignas(64) std::atomic<index_t> m_bottom {0}; // owner end
+    alignas(64) std::atomic<T> m_cells[N] {};
+}; // class Inplace_ws_deque
+
+} // namespace impl
+
+template <typename T, size_t N>
+using inplace_ws_deque = impl::Inplace_ws_deque<T, N>;
+
+#endif // INPLACE_DEQUE_HPP
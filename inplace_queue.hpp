@@ -0,0 +1,305 @@
+/* Inplace bounded lock-free queues in C++14 and later */
+/*
+  inplace_spsc_queue<T, N> - wait-free, one producer thread and one consumer thread
+  inplace_mpmc_queue<T, N> - lock-free, any count of producers and consumers
+                             (D. Vyukov bounded queue, sequence number per cell)
+
+Storage is inline like in inplace_stack, no allocation after construction.
+Producer and consumer indexes are on own cache lines.
+try_push_n / try_pop_n move as many elements as fit with one index update.
+*/
+#ifndef INPLACE_QUEUE_HPP
+#define INPLACE_QUEUE_HPP
+
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace impl {
+
+namespace detail {
+
+constexpr size_t queue_cache_line = 64;
+
+} // namespace detail
+
+template <typename T, size_t N>
+class Inplace_spsc_queue {
+    static_assert(N > 0, "Capacity of Inplace_spsc_queue must be positive");
+
+public:
+    using value_type = T;
+
+public:
+    Inplace_spsc_queue() = default;
+    ~Inplace_spsc_queue() {
+        if (!std::is_trivially_destructible<T>::value)
+            while (try_pop_destroy()) {}
+    }
+
+    Inplace_spsc_queue(const Inplace_spsc_queue&) = delete;
+    Inplace_spsc_queue& operator=(const Inplace_spsc_queue&) = delete;
+
+    // producer side
+    bool try_push(const T& new_value) { return try_emplace(new_value); }
+    bool try_push(T&& new_value) { return try_emplace(std::move(new_value)); }
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        if (tail - m_head_cache == N) {
+            m_head_cache = m_head.value.load(std::memory_order_acquire);
+            if (tail - m_head_cache == N)
+                return false;
+        }
+        new (cell(tail)) T(std::forward<Args>(args)...);
+        m_tail.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pushes up to 'count' elements from 'first', returns count of pushed
+    template <typename It>
+    size_t try_push_n(It first, size_t count) {
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        if (N - (tail - m_head_cache) < count)
+            m_head_cache = m_head.value.load(std::memory_order_acquire);
+        const size_t free = N - (tail - m_head_cache);
+        if (count > free) count = free;
+        for (size_t i = 0; i < count; i++, ++first)
+            new (cell(tail + i)) T(*first);
+        m_tail.value.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // consumer side
+    bool try_pop(T& out) {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if (head == m_tail_cache) {
+            m_tail_cache = m_tail.value.load(std::memory_order_acquire);
+            if (head == m_tail_cache)
+                return false;
+        }
+        T* value = cell(head);
+        out = std::move(*value);
+        value->~T();
+        m_head.value.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pops up to 'count' elements to 'out', returns count of popped
+    template <typename OutIt>
+    size_t try_pop_n(OutIt out, size_t count) {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if (m_tail_cache - head < count)
+            m_tail_cache = m_tail.value.load(std::memory_order_acquire);
+        const size_t ready = m_tail_cache - head;
+        if (count > ready) count = ready;
+        for (size_t i = 0; i < count; i++, ++out) {
+            T* value = cell(head + i);
+            *out = std::move(*value);
+            value->~T();
+        }
+        m_head.value.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // exact only if called by producer or consumer while other side is idle
+    size_t size_approx() const noexcept {
+        const size_t head = m_head.value.load(std::memory_order_acquire);
+        const size_t tail = m_tail.value.load(std::memory_order_acquire);
+        return tail - head;
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    struct alignas(detail::queue_cache_line) index_t {
+        std::atomic<size_t> value {0};
+    };
+
+    T* cell(size_t index) noexcept {
+        return reinterpret_cast<T*>(m_data + (index % N) * sizeof(T));
+    }
+
+    bool try_pop_destroy() noexcept {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if (head == m_tail.value.load(std::memory_order_acquire))
+            return false;
+        cell(head)->~T();
+        m_head.value.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    index_t m_head;                                                 // written by consumer
+    alignas(detail::queue_cache_line) size_t m_tail_cache = 0;      // consumer copy of tail
+    index_t m_tail;                                                 // written by producer
+    alignas(detail::queue_cache_line) size_t m_head_cache = 0;      // producer copy of head
+    alignas(detail::queue_cache_line) alignas(T) char m_data[N * sizeof(T)];
+}; // class Inplace_spsc_queue
+
+template <typename T, size_t N>
+class Inplace_mpmc_queue {
+    static_assert(N > 0, "Capacity of Inplace_mpmc_queue must be positive");
+
+public:
+    using value_type = T;
+
+public:
+    Inplace_mpmc_queue() noexcept {
+        for (size_t i = 0; i < N; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ~Inplace_mpmc_queue() {
+        if (std::is_trivially_destructible<T>::value) return;
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        for (size_t pos = m_head.value.load(std::memory_order_relaxed); pos != tail; pos++)
+            m_cells[pos % N].value()->~T();
+    }
+
+    Inplace_mpmc_queue(const Inplace_mpmc_queue&) = delete;
+    Inplace_mpmc_queue& operator=(const Inplace_mpmc_queue&) = delete;
+
+    bool try_push(const T& new_value) { return try_emplace(new_value); }
+    bool try_push(T&& new_value) { return try_emplace(std::move(new_value)); }
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos = m_tail.value.load(std::memory_order_relaxed);
+        for (;;) {
+            cell_t& c = m_cells[pos % N];
+            const size_t seq = c.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (m_tail.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (c.value()) T(std::forward<Args>(args)...);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_tail.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // pushes up to 'count' elements from 'first' to consecutive cells, returns count of pushed
+    template <typename It>
+    size_t try_push_n(It first, size_t count) {
+        if (count == 0) return 0;
+        size_t pos = m_tail.value.load(std::memory_order_relaxed);
+        size_t ready;
+        do {
+            ready = 0;
+            while (ready < count && ready < N
+                && m_cells[(pos + ready) % N].sequence.load(std::memory_order_acquire) == pos + ready)
+                ready++;
+            if (ready == 0) {
+                const size_t seq = m_cells[pos % N].sequence.load(std::memory_order_acquire);
+                if (static_cast<ptrdiff_t>(seq - pos) < 0) return 0; // full
+                pos = m_tail.value.load(std::memory_order_relaxed);
+                continue;
+            }
+        } while (ready == 0 || !m_tail.value.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < ready; i++, ++first) {
+            cell_t& c = m_cells[(pos + i) % N];
+            new (c.value()) T(*first);
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return ready;
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = m_head.value.load(std::memory_order_relaxed);
+        for (;;) {
+            cell_t& c = m_cells[pos % N];
+            const size_t seq = c.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = static_cast<ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (m_head.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* value = c.value();
+                    out = std::move(*value);
+                    value->~T();
+                    c.sequence.store(pos + N, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = m_head.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // pops up to 'count' elements from consecutive cells to 'out', returns count of popped
+    template <typename OutIt>
+    size_t try_pop_n(OutIt out, size_t count) {
+        if (count == 0) return 0;
+        size_t pos = m_head.value.load(std::memory_order_relaxed);
+        size_t ready;
+        do {
+            ready = 0;
+            while (ready < count && ready < N
+                && m_cells[(pos + ready) % N].sequence.load(std::memory_order_acquire) == pos + ready + 1)
+                ready++;
+            if (ready == 0) {
+                const size_t seq = m_cells[pos % N].sequence.load(std::memory_order_acquire);
+                if (static_cast<ptrdiff_t>(seq - (pos + 1)) < 0) return 0; // empty
+                pos = m_head.value.load(std::memory_order_relaxed);
+                continue;
+            }
+        } while (ready == 0 || !m_head.value.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < ready; i++, ++out) {
+            cell_t& c = m_cells[(pos + i) % N];
+            T* value = c.value();
+            *out = std::move(*value);
+            value->~T();
+            c.sequence.store(pos + i + N, std::memory_order_release);
+        }
+        return ready;
+    }
+
+    size_t size_approx() const noexcept {
+        const size_t head = m_head.value.load(std::memory_order_acquire);
+        const size_t tail = m_tail.value.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    struct alignas(detail::queue_cache_line) index_t {
+        std::atomic<size_t> value {0};
+    };
+
+    struct cell_t {
+        std::atomic<size_t> sequence;
+        alignas(T) char storage[sizeof(T)];
+
+        T* value() noexcept { return reinterpret_cast<T*>(storage); }
+    };
+
+private:
+    index_t m_head; // next position to pop
+    index_t m_tail; // next position to push
+    alignas(detail::queue_cache_line) cell_t m_cells[N];
+}; // class Inplace_mpmc_queue
+
+} // namespace impl
+
+template <typename T, size_t N>
+using inplace_spsc_queue = impl::Inplace_spsc_queue<T, N>;
+
+template <typename T, size_t N>
+using inplace_mpmc_queue = impl::Inplace_mpmc_queue<T, N>;
+
+// safe for any count of threads, use inplace_spsc_queue for one producer and one consumer
+template <typename T, size_t N>
+using inplace_queue = impl::Inplace_mpmc_queue<T, N>;
+
+#endif // INPLACE_QUEUE_HPP
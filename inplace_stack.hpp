@@ -7,8 +7,22 @@
 #include <utility>
 #include <cstddef>
 #include <cstring>
+#include <iterator>
 #include <new>
 
+#if __cplusplus >= 202002L // C++20
+#include <cstdint>
+#endif
+
+#ifdef INPLACE_STACK_LAZY_STORAGE
+#error "INPLACE_STACK_LAZY_STORAGE is replaced by inplace_lazy_stack (C++20)"
+#endif
+
+// Type can be moved to other address by memcpy, old copy is not destroyed.
+// Trivially copyable types are relocatable, specialize for others (as unique_ptr-like handles)
+template <typename T>
+struct inplace_trivially_relocatable : std::is_trivially_copyable<T> {};
+
 namespace impl {
 
 namespace detail {
@@ -21,47 +35,116 @@ template <typename T>
 constexpr bool nothrow_swap = noexcept(std::swap(std::declval<T&>(), std::declval<T&>()));
 #endif
 
-} // namespace detail
+// std::distance is constexpr only since C++17
+template <typename It>
+constexpr size_t distance(It first, It last, std::random_access_iterator_tag) {
+    return static_cast<size_t>(last - first);
+}
+template <typename It>
+constexpr size_t distance(It first, It last, std::input_iterator_tag) {
+    size_t count = 0;
+    for (; first != last; ++first) count++;
+    return count;
+}
+template <typename It>
+constexpr size_t distance(It first, It last) {
+    return distance(first, last, typename std::iterator_traits<It>::iterator_category());
+}
+
+// elements of Inplace_stack_is_cexpr, zeroed at construction
+template <typename T, size_t N, bool Lazy>
+struct cexpr_storage {
+    static_assert(!Lazy, "Lazy storage of Inplace_stack_is_cexpr needs C++20");
+
+    T data[N] {};
+    size_t size = 0;
+
+    constexpr void swap(cexpr_storage& other) noexcept(nothrow_swap<T>) {
+        using std::swap;
+        swap(data, other.data);
+        swap(size, other.size);
+    }
+};
 
+#if __cplusplus >= 202002L // C++20
+template <size_t N>
+using size_for = std::conditional_t<N <= UINT8_MAX, uint8_t,
+                 std::conditional_t<N <= UINT16_MAX, uint16_t,
+                 std::conditional_t<N <= UINT32_MAX, uint32_t, size_t>>>;
+
+// not zeroed at construction (only in constant evaluation), size uses smallest type
 template <typename T, size_t N>
+struct cexpr_storage<T, N, true> {
+    union {
+        T data[N];
+    };
+    size_for<N> size = 0;
+
+    constexpr cexpr_storage() noexcept {
+        // constant evaluation can not leave storage uninitialized
+        if (std::is_constant_evaluated())
+            for (size_t i = 0; i < N; i++)
+                data[i] = T();
+    }
+
+    // elements above size may be uninitialized, swap only live ones
+    constexpr void swap(cexpr_storage& other) noexcept(nothrow_swap<T>) {
+        using std::swap;
+        cexpr_storage& shorter = size < other.size ? *this : other;
+        cexpr_storage& longer  = size < other.size ? other : *this;
+        for (size_t i = 0; i < shorter.size; i++)
+            swap(shorter.data[i], longer.data[i]);
+        for (size_t i = shorter.size; i < longer.size; i++)
+            shorter.data[i] = longer.data[i];
+        swap(size, other.size);
+    }
+};
+#endif
+
+} // namespace detail
+
+// Lazy (C++20): storage is not zeroed at construction, see inplace_lazy_stack
+template <typename T, size_t N, bool Lazy = false>
 class Inplace_stack_is_cexpr {
 public:
     using value_type = T;
     using pointer    = T*;
     using reference  = T&;
     using const_reference = const T&;
+    using iterator       = T*;
+    using const_iterator = const T*;
 
 public:
     constexpr Inplace_stack_is_cexpr() = default;
-    constexpr Inplace_stack_is_cexpr(std::initializer_list<T> il) {
+    constexpr Inplace_stack_is_cexpr(std::initializer_list<T> il) : Inplace_stack_is_cexpr() {
         const size_t count = il.size() < N ? il.size() : N;
         auto begin = il.begin();
         for (size_t i = 0; i < count; i++)
-            m_data[i] = *begin++;
-        m_size = count;
+            storage()[i] = *begin++;
+        m_storage.size = count;
     }
 
     constexpr void push(const T& new_value) {
         if (size() == capacity())
             throw std::bad_alloc();
-        m_data[m_size++] = new_value;
+        storage()[m_storage.size++] = new_value;
     }
     constexpr void push(T&& new_value) {
         if (size() == capacity())
             throw std::bad_alloc();
-        m_data[m_size++] = std::move(new_value);
+        storage()[m_storage.size++] = std::move(new_value);
     }
 
     constexpr pointer try_push(const T& new_value) {
         if (size() == capacity())
             return nullptr;
-        m_data[m_size++] = new_value;
+        storage()[m_storage.size++] = new_value;
         return &top();
     }
     constexpr pointer try_push(T&& new_value) {
         if (size() == capacity())
             return nullptr;
-        m_data[m_size++] = std::move(new_value);
+        storage()[m_storage.size++] = std::move(new_value);
         return &top();
     }
 
@@ -69,44 +152,93 @@ public:
     constexpr reference emplace(Args&&... args) {
         if (size() == capacity())
             throw std::bad_alloc();
-        m_data[m_size++] = T(std::forward<Args>(args)...);
+        storage()[m_storage.size++] = T(std::forward<Args>(args)...);
         return top();
     }
     template <typename... Args>
     constexpr pointer try_emplace(Args&&... args) {
         if (size() == capacity())
             return nullptr;
-        m_data[m_size++] = T(std::forward<Args>(args)...);
+        storage()[m_storage.size++] = T(std::forward<Args>(args)...);
         return &top();
     }
 
+    // pushes all or throws std::bad_alloc without pushing, It is forward iterator
+    template <typename It>
+    constexpr void push_range(It first, It last) {
+        if (!try_push_range(first, last))
+            throw std::bad_alloc();
+    }
+    template <typename It>
+    constexpr bool try_push_range(It first, It last) {
+        const size_t count = detail::distance(first, last);
+        if (count > capacity() - size())
+            return false;
+        copy_range(first, last, count, std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value && std::is_pointer<It>::value
+            && std::is_same<typename std::remove_cv<typename std::iterator_traits<It>::value_type>::type, T>::value>());
+        m_storage.size += count;
+        return true;
+    }
+
     constexpr void pop() {
         if (empty()) return;
-        --m_size;
+        --m_storage.size;
+    }
+    // pops min(count, size()) elements
+    constexpr void pop_n(size_t count) noexcept {
+        m_storage.size -= count < size() ? count : size();
     }
 
     constexpr reference top() noexcept {
-        return m_data[m_size - 1];
+        return storage()[m_storage.size - 1];
     }
     constexpr const_reference top() const noexcept {
-        return m_data[m_size - 1];
+        return storage()[m_storage.size - 1];
     }
 
-    constexpr bool empty() const noexcept { return m_size == 0; }
-    constexpr bool full()  const noexcept { return m_size == N; }
-    constexpr size_t size() const noexcept { return m_size; }
+    constexpr pointer data() noexcept { return storage(); }
+    constexpr const T* data() const noexcept { return storage(); }
+
+    // live elements from bottom to top
+    constexpr iterator begin() noexcept { return storage(); }
+    constexpr iterator end() noexcept { return storage() + m_storage.size; }
+    constexpr const_iterator begin() const noexcept { return storage(); }
+    constexpr const_iterator end() const noexcept { return storage() + m_storage.size; }
+
+    constexpr bool empty() const noexcept { return m_storage.size == 0; }
+    constexpr bool full()  const noexcept { return m_storage.size == N; }
+    constexpr size_t size() const noexcept { return m_storage.size; }
     static constexpr size_t capacity() noexcept { return N; }
 
     constexpr void swap(Inplace_stack_is_cexpr& other)
     noexcept(detail::nothrow_swap<T>) {
-        using std::swap;
-        swap(m_data, other.m_data);
-        swap(m_size, other.m_size);
+        m_storage.swap(other.m_storage);
     }
 
 private:
-    T m_data[N] {};
-    size_t m_size = 0;
+    template <typename It>
+    constexpr void copy_range(It first, It last, size_t count, std::true_type) {
+#ifdef __cpp_lib_is_constant_evaluated
+        // memcpy is not constexpr, loop is kept for constant evaluation
+        if (!std::is_constant_evaluated()) {
+            if (count) std::memcpy(storage() + m_storage.size, first, count * sizeof(T));
+            return;
+        }
+#endif
+        copy_range(first, last, count, std::false_type());
+    }
+    template <typename It>
+    constexpr void copy_range(It first, It last, size_t, std::false_type) {
+        pointer out = storage() + m_storage.size;
+        for (; first != last; ++first)
+            *out++ = *first;
+    }
+
+    detail::cexpr_storage<T, N, Lazy> m_storage;
+
+    constexpr pointer storage() noexcept { return m_storage.data; }
+    constexpr const T* storage() const noexcept { return m_storage.data; }
 }; // class Inplace_stack_is_cexpr
 
 template <typename T, size_t N>
@@ -116,30 +248,31 @@ public:
     using pointer    = T*;
     using reference  = T&;
     using const_reference = const T&;
+    using iterator       = T*;
+    using const_iterator = const T*;
 
 public:
     Inplace_stack_no_cexpr() = default;
     Inplace_stack_no_cexpr(std::initializer_list<T> il) {
         const size_t count = il.size() < N ? il.size() : N;
-        auto begin = il.begin();
-        for (size_t i = 0; i < count; i++)
-            push(*begin++);
-        m_size = count;
+        push_range(il.begin(), il.begin() + count);
     }
     ~Inplace_stack_no_cexpr() {
-        while (!empty()) pop();
+        destroy_all();
     }
 
     Inplace_stack_no_cexpr(const Inplace_stack_no_cexpr& other) {
-        for (size_t i = 0; i < other.size(); i++)
-            push(*reinterpret_cast<const T*>(
-                other.m_data + i * sizeof(T)));
+        if (std::is_trivially_copyable<T>::value) {
+            std::memcpy(m_data, other.m_data, other.size() * sizeof(T));
+            m_size = other.size();
+        } else {
+            for (size_t i = 0; i < other.size(); i++)
+                new (get_next_cell()) T(*other.cell(i));
+        }
     }
-    Inplace_stack_no_cexpr(Inplace_stack_no_cexpr&& other) noexcept {
-        std::memcpy(m_data, other.m_data, N * sizeof(T));
-        std::memset(other.m_data, 0, N * sizeof(T));
-        m_size = std::move(other.m_size);
-        other.m_size = 0;
+    Inplace_stack_no_cexpr(Inplace_stack_no_cexpr&& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        relocate_from(other, 0);
     }
 
     Inplace_stack_no_cexpr& operator=(const Inplace_stack_no_cexpr& other) {
@@ -147,8 +280,12 @@ public:
         tmp.swap(*this);
         return *this;
     }
-    Inplace_stack_no_cexpr& operator=(Inplace_stack_no_cexpr&& other) noexcept {
-        other.swap(*this);
+    Inplace_stack_no_cexpr& operator=(Inplace_stack_no_cexpr&& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            destroy_all();
+            relocate_from(other, 0);
+        }
         return *this;
     }
 
@@ -191,29 +328,130 @@ public:
         return get_curr_cell();
     }
 
+    // pushes all or throws std::bad_alloc without pushing, It is forward iterator
+    template <typename It>
+    void push_range(It first, It last) {
+        if (!try_push_range(first, last))
+            throw std::bad_alloc();
+    }
+    template <typename It>
+    bool try_push_range(It first, It last) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count > capacity() - size())
+            return false;
+        copy_range(first, last, count, std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value && std::is_pointer<It>::value
+            && std::is_same<typename std::remove_cv<typename std::iterator_traits<It>::value_type>::type, T>::value>());
+        return true;
+    }
+
     void pop() {
         if (empty()) return;
         get_last_cell()->~T();
     }
+    // pops min(count, size()) elements
+    void pop_n(size_t count) noexcept {
+        if (count > size()) count = size();
+        if (std::is_trivially_destructible<T>::value)
+            m_size -= count;
+        else
+            while (count--) pop();
+    }
 
     reference top() { return *get_curr_cell(); }
     const_reference top() const { return *get_curr_cell(); }
 
+    pointer data() noexcept { return cell(0); }
+    const T* data() const noexcept { return cell(0); }
+
+    // live elements from bottom to top
+    iterator begin() noexcept { return cell(0); }
+    iterator end() noexcept { return cell(m_size); }
+    const_iterator begin() const noexcept { return cell(0); }
+    const_iterator end() const noexcept { return cell(m_size); }
+
     bool empty() const noexcept { return m_size == 0; }
     bool full()  const noexcept { return m_size == N; }
     size_t size() const noexcept { return m_size; }
     static constexpr size_t capacity() noexcept { return N; }
 
     void swap(Inplace_stack_no_cexpr& other)
-    noexcept(detail::nothrow_swap<T>) {
+    noexcept(relocatable || (detail::nothrow_swap<T> && std::is_nothrow_move_constructible<T>::value)) {
+        if (this == &other) return;
+        if (relocatable) {
+            // only bytes of live elements are exchanged
+            const size_t bytes = (size() > other.size() ? size() : other.size()) * sizeof(T);
+            char tmp[256];
+            for (size_t done = 0; done < bytes; done += sizeof tmp) {
+                const size_t step = bytes - done < sizeof tmp ? bytes - done : sizeof tmp;
+                std::memcpy(tmp, m_data + done, step);
+                std::memcpy(m_data + done, other.m_data + done, step);
+                std::memcpy(other.m_data + done, tmp, step);
+            }
+            std::swap(m_size, other.m_size);
+            return;
+        }
+
+        Inplace_stack_no_cexpr& shorter = size() < other.size() ? *this : other;
+        Inplace_stack_no_cexpr& longer  = size() < other.size() ? other : *this;
         using std::swap;
-        swap(m_data, other.m_data);
-        swap(m_size, other.m_size);
+        for (size_t i = 0; i < shorter.size(); i++)
+            swap(*shorter.cell(i), *longer.cell(i));
+        shorter.relocate_from(longer, shorter.size());
     }
 
 private:
-    const pointer get_curr_cell() const {
-        return reinterpret_cast<const pointer>(
+    static constexpr bool relocatable = inplace_trivially_relocatable<T>::value;
+
+    pointer cell(size_t index) {
+        return reinterpret_cast<pointer>(m_data + index * sizeof(T));
+    }
+    const T* cell(size_t index) const {
+        return reinterpret_cast<const T*>(m_data + index * sizeof(T));
+    }
+
+    template <typename It>
+    void copy_range(It first, It, size_t count, std::true_type) {
+        std::memcpy(cell(m_size), first, count * sizeof(T));
+        m_size += count;
+    }
+    template <typename It>
+    void copy_range(It first, It last, size_t, std::false_type) {
+        // strong guarantee: constructed elements are destroyed if constructor throws
+        const size_t old_size = m_size;
+        try {
+            for (; first != last; ++first, ++m_size)
+                new (cell(m_size)) T(*first);
+        } catch (...) {
+            pop_n(m_size - old_size);
+            throw;
+        }
+    }
+
+    void destroy_all() noexcept {
+        if (!std::is_trivially_destructible<T>::value)
+            while (!empty()) pop();
+        m_size = 0;
+    }
+
+    // moves elements [from, other.size()) to end of this, 'other' is left with 'from' elements
+    void relocate_from(Inplace_stack_no_cexpr& other, size_t from)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        const size_t count = other.size() - from;
+        if (relocatable) {
+            std::memcpy(m_data + m_size * sizeof(T), other.m_data + from * sizeof(T), count * sizeof(T));
+            m_size += count;
+        } else {
+            for (size_t i = from; i < other.size(); i++)
+                new (get_next_cell()) T(std::move(*other.cell(i)));
+            for (size_t i = from; i < other.size(); i++)
+                other.cell(i)->~T();
+        }
+        other.m_size = from;
+    }
+
+    const T* get_curr_cell() const {
+        return reinterpret_cast<const T*>(
             m_data + (m_size - 1) * sizeof(T));
     }
     pointer get_curr_cell() {
@@ -230,11 +468,11 @@ private:
     }
 
 private:
-    alignas(T) char m_data[N * sizeof(T)] {};
+    alignas(T) char m_data[N * sizeof(T)];
     size_t m_size = 0;
 }; // class Inplace_stack_no_cexpr
 
-template <typename T> class Inplace_stack_is_cexpr<T, 0> {};
+template <typename T, bool Lazy> class Inplace_stack_is_cexpr<T, 0, Lazy> {};
 template <typename T> class Inplace_stack_no_cexpr<T, 0> {};
 
 } // namespace impl
@@ -246,6 +484,16 @@ using inplace_stack = typename std::conditional<
     impl::Inplace_stack_no_cexpr<T, N>
 >::type;
 
+#if __cplusplus >= 202002L // C++20
+// as inplace_stack, but storage of trivial T is not zeroed at construction
+template <typename T, size_t N>
+using inplace_lazy_stack = typename std::conditional<
+    std::is_trivial<T>::value,
+    impl::Inplace_stack_is_cexpr<T, N, true>,
+    impl::Inplace_stack_no_cexpr<T, N>
+>::type;
+#endif
+
 namespace std {
     template <typename T, size_t N>
     constexpr void swap(inplace_stack<T, N>& a, inplace_stack<T, N>& b)
@@ -0,0 +1,232 @@
+/* Optional instrumentation of hot paths in hash and PRNG headers in C */
+/*
+With SOH_INSTRUMENT defined (for every translation unit) hooks count per
+kind: calls, bytes and cycles (rdtsc, CLOCK_MONOTONIC ns elsewhere):
+  SOH_INSTR_SHA256, SOH_INSTR_SHA256_FILE   - sha256_d_base
+  SOH_INSTR_SIPHASH, SOH_INSTR_SIPHASH_FILE - siphash_d_base
+  SOH_INSTR_FNV_FILE, SOH_INSTR_PJW_FILE    - fnv*_file, pjw_*_file
+  SOH_INSTR_XORSHIFT                        - xorshift.h and xorshift.hpp,
+                                              bytes of values, no cycles
+Counters are per thread without locked instructions, blocks of all
+threads are linked in list, counters of finished threads are added to
+common totals. Instrumented headers include this file only with
+SOH_INSTRUMENT, without it hooks expand to nothing and it is not needed.
+
+  soh_instr_counter_t c[SOH_INSTR_KINDS];
+  soh_instr_snapshot(c);  // all threads, since last soh_instr_reset
+  printf("%s %llu bytes\n", soh_instr_name(SOH_INSTR_SHA256),
+      (unsigned long long)c[SOH_INSTR_SHA256].bytes);
+
+For linking need define in one translation unit with SOH_INSTRUMENT:
+  SOH_INSTRUMENT_IMPLEMENTATION
+*/
+#ifndef SOH_INSTRUMENT_H
+#define SOH_INSTRUMENT_H
+
+#ifdef SOH_INSTRUMENT
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(__x86_64__) && !defined(__i386__)
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SOH_INSTR_SHA256 = 0,
+    SOH_INSTR_SHA256_FILE,
+    SOH_INSTR_SIPHASH,
+    SOH_INSTR_SIPHASH_FILE,
+    SOH_INSTR_FNV_FILE,
+    SOH_INSTR_PJW_FILE,
+    SOH_INSTR_XORSHIFT,
+    SOH_INSTR_KINDS
+} soh_instr_kind_t;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t cycles;
+} soh_instr_counter_t;
+
+typedef struct {
+    soh_instr_kind_t kind;
+    uint64_t start;
+    uint64_t bytes;
+} soh_instr_scope_t;
+
+// 'out' has SOH_INSTR_KINDS elements
+void soh_instr_snapshot(soh_instr_counter_t* out);        // all threads, since reset
+void soh_instr_thread_snapshot(soh_instr_counter_t* out); // calling thread, since its start
+void soh_instr_reset(void);
+const char* soh_instr_name(soh_instr_kind_t kind);
+
+extern __thread soh_instr_counter_t* soh_d_instr_local;
+soh_instr_counter_t* soh_d_instr_attach(void);
+
+static inline uint64_t soh_instr_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// only owner thread writes, relaxed stores let snapshot read without race
+static inline void soh_instr_add(soh_instr_kind_t kind, uint64_t bytes, uint64_t cycles) {
+    soh_instr_counter_t* c = soh_d_instr_local;
+    if (!c) c = soh_d_instr_attach();
+    c += kind;
+    __atomic_store_n(&c->calls,  c->calls + 1,       __ATOMIC_RELAXED);
+    __atomic_store_n(&c->bytes,  c->bytes + bytes,   __ATOMIC_RELAXED);
+    __atomic_store_n(&c->cycles, c->cycles + cycles, __ATOMIC_RELAXED);
+}
+
+static inline soh_instr_scope_t soh_instr_begin(soh_instr_kind_t kind) {
+    soh_instr_scope_t scope;
+    scope.kind = kind;
+    scope.start = soh_instr_ticks();
+    scope.bytes = 0;
+    return scope;
+}
+
+static inline void soh_instr_end(const soh_instr_scope_t* scope) {
+    soh_instr_add(scope->kind, scope->bytes, soh_instr_ticks() - scope->start);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#define SOH_INSTR_BEGIN(scope, kind) soh_instr_scope_t scope = soh_instr_begin(kind)
+#define SOH_INSTR_BYTES(scope, n)    (scope).bytes += (n)
+#define SOH_INSTR_END(scope)         soh_instr_end(&(scope))
+#define SOH_INSTR_ADD(kind, bytes)   soh_instr_add((kind), (bytes), 0)
+
+#else // SOH_INSTRUMENT
+
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+
+#endif // SOH_INSTRUMENT
+
+#endif // SOH_INSTRUMENT_H
+
+#if defined(SOH_INSTRUMENT_IMPLEMENTATION) && defined(SOH_INSTRUMENT)
+#ifndef SOH_INSTRUMENT_IMPLEMENTATION_DONE
+#define SOH_INSTRUMENT_IMPLEMENTATION_DONE
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct soh_d_instr_block {
+    soh_instr_counter_t counters[SOH_INSTR_KINDS];
+    struct soh_d_instr_block* prev;
+    struct soh_d_instr_block* next;
+} soh_d_instr_block;
+
+__thread soh_instr_counter_t* soh_d_instr_local;
+
+soh_d_instr_block* soh_d_instr_threads;
+soh_instr_counter_t soh_d_instr_retired[SOH_INSTR_KINDS]; // finished threads
+soh_instr_counter_t soh_d_instr_base[SOH_INSTR_KINDS];    // raw totals at reset
+pthread_mutex_t soh_d_instr_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t soh_d_instr_once = PTHREAD_ONCE_INIT;
+pthread_key_t soh_d_instr_key;
+
+void soh_d_instr_accumulate(soh_instr_counter_t* out, const soh_instr_counter_t* from) {
+    for (size_t i = 0; i < SOH_INSTR_KINDS; i++) {
+        out[i].calls  += __atomic_load_n(&from[i].calls,  __ATOMIC_RELAXED);
+        out[i].bytes  += __atomic_load_n(&from[i].bytes,  __ATOMIC_RELAXED);
+        out[i].cycles += __atomic_load_n(&from[i].cycles, __ATOMIC_RELAXED);
+    }
+}
+
+void soh_d_instr_detach(void* block_ptr) {
+    soh_d_instr_block* block = (soh_d_instr_block*)block_ptr;
+    pthread_mutex_lock(&soh_d_instr_mutex);
+    soh_d_instr_accumulate(soh_d_instr_retired, block->counters);
+    if (block->prev) block->prev->next = block->next;
+    else soh_d_instr_threads = block->next;
+    if (block->next) block->next->prev = block->prev;
+    pthread_mutex_unlock(&soh_d_instr_mutex);
+    soh_d_instr_local = NULL;
+    free(block);
+}
+
+void soh_d_instr_init(void) {
+    pthread_key_create(&soh_d_instr_key, soh_d_instr_detach);
+}
+
+soh_instr_counter_t* soh_d_instr_attach(void) {
+    // without memory counts are dropped into shared sink, still no crash
+    static soh_instr_counter_t sink[SOH_INSTR_KINDS];
+    pthread_once(&soh_d_instr_once, soh_d_instr_init);
+    soh_d_instr_block* block = (soh_d_instr_block*)calloc(1, sizeof *block);
+    if (!block) return sink;
+
+    pthread_mutex_lock(&soh_d_instr_mutex);
+    block->next = soh_d_instr_threads;
+    if (block->next) block->next->prev = block;
+    soh_d_instr_threads = block;
+    pthread_mutex_unlock(&soh_d_instr_mutex);
+
+    pthread_setspecific(soh_d_instr_key, block);
+    return soh_d_instr_local = block->counters;
+}
+
+void soh_d_instr_raw(soh_instr_counter_t* out) {
+    memcpy(out, soh_d_instr_retired, sizeof soh_d_instr_retired);
+    for (soh_d_instr_block* b = soh_d_instr_threads; b; b = b->next)
+        soh_d_instr_accumulate(out, b->counters);
+}
+
+void soh_instr_snapshot(soh_instr_counter_t* out) {
+    pthread_mutex_lock(&soh_d_instr_mutex);
+    soh_d_instr_raw(out);
+    for (size_t i = 0; i < SOH_INSTR_KINDS; i++) {
+        out[i].calls  -= soh_d_instr_base[i].calls;
+        out[i].bytes  -= soh_d_instr_base[i].bytes;
+        out[i].cycles -= soh_d_instr_base[i].cycles;
+    }
+    pthread_mutex_unlock(&soh_d_instr_mutex);
+}
+
+void soh_instr_thread_snapshot(soh_instr_counter_t* out) {
+    memset(out, 0, sizeof(soh_instr_counter_t) * SOH_INSTR_KINDS);
+    if (soh_d_instr_local)
+        soh_d_instr_accumulate(out, soh_d_instr_local);
+}
+
+// counters of other threads are only read, reset moves base
+void soh_instr_reset(void) {
+    pthread_mutex_lock(&soh_d_instr_mutex);
+    soh_d_instr_raw(soh_d_instr_base);
+    pthread_mutex_unlock(&soh_d_instr_mutex);
+}
+
+const char* soh_instr_name(soh_instr_kind_t kind) {
+    switch (kind) {
+    case SOH_INSTR_SHA256:       return "sha256";
+    case SOH_INSTR_SHA256_FILE:  return "sha256_file";
+    case SOH_INSTR_SIPHASH:      return "siphash";
+    case SOH_INSTR_SIPHASH_FILE: return "siphash_file";
+    case SOH_INSTR_FNV_FILE:     return "fnv_file";
+    case SOH_INSTR_PJW_FILE:     return "pjw_file";
+    case SOH_INSTR_XORSHIFT:     return "xorshift";
+    case SOH_INSTR_KINDS:        break;
+    }
+    return "unknown";
+}
+
+#endif // SOH_INSTRUMENT_IMPLEMENTATION_DONE
+#endif // SOH_INSTRUMENT_IMPLEMENTATION
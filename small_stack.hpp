@@ -0,0 +1,385 @@
+/* Small vector and stack in C++14 and later, first N elements inline, others on heap */
+#ifndef SMALL_STACK_HPP
+#define SMALL_STACK_HPP
+
+#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "inplace_stack.hpp"
+
+// Counters shared by all containers of one instantiation, to tune N
+struct small_spill_stats {
+    std::atomic<size_t> spills {0}; // inline storage exceeded, moved to heap
+    std::atomic<size_t> grows  {0}; // heap buffer reallocated
+    std::atomic<size_t> peak   {0}; // biggest heap capacity
+};
+
+namespace impl {
+
+template <typename T, size_t N, typename Allocator>
+class Small_vector {
+    static_assert(N > 0, "Small_vector needs inline capacity, use std::vector for N == 0");
+
+    using alloc_traits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+    using alloc_type   = typename alloc_traits::allocator_type;
+
+public:
+    using value_type     = T;
+    using allocator_type = Allocator;
+    using pointer        = T*;
+    using reference      = T&;
+    using const_reference = const T&;
+    using iterator       = T*;
+    using const_iterator = const T*;
+    using size_type      = size_t;
+
+public:
+    Small_vector() noexcept(noexcept(alloc_type())) : m_heap() {}
+    explicit Small_vector(const Allocator& alloc) noexcept : m_heap(alloc) {}
+    Small_vector(std::initializer_list<T> il, const Allocator& alloc = Allocator()) : m_heap(alloc) {
+        append(il.begin(), il.end());
+    }
+    ~Small_vector() {
+        clear();
+        release();
+    }
+
+    Small_vector(const Small_vector& other)
+    : m_heap(alloc_traits::select_on_container_copy_construction(other.m_heap)) {
+        append(other.begin(), other.end());
+    }
+    Small_vector(Small_vector&& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value)
+    : m_heap(std::move(other.m_heap)) {
+        take(other);
+    }
+
+    Small_vector& operator=(const Small_vector& other) {
+        if (this != &other) {
+            clear();
+            append(other.begin(), other.end());
+        }
+        return *this;
+    }
+    Small_vector& operator=(Small_vector&& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        if (this == &other) return *this;
+        clear();
+        if (!other.is_inline() && !(static_cast<alloc_type&>(m_heap) == other.m_heap)
+            && !alloc_traits::propagate_on_container_move_assignment::value) {
+            // buffer can not change owner, move by elements
+            reserve(other.size());
+            relocate(other.m_data, other.m_size, m_data);
+            m_size = other.m_size;
+            other.m_size = 0;
+            return *this;
+        }
+        release();
+        if (alloc_traits::propagate_on_container_move_assignment::value)
+            static_cast<alloc_type&>(m_heap) = std::move(static_cast<alloc_type&>(other.m_heap));
+        take(other);
+        return *this;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (m_size == m_capacity)
+            return grow_emplace(std::forward<Args>(args)...);
+        alloc_traits::construct(m_heap, m_data + m_size, std::forward<Args>(args)...);
+        return m_data[m_size++];
+    }
+
+    // appends all elements of forward range, one capacity check
+    template <typename It>
+    void append(It first, It last) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count > m_capacity - m_size)
+            reserve(std::max(m_size + count, m_capacity * 2));
+        const size_t old_size = m_size;
+        try {
+            for (; first != last; ++first, ++m_size)
+                alloc_traits::construct(m_heap, m_data + m_size, *first);
+        } catch (...) {
+            pop_back_n(m_size - old_size);
+            throw;
+        }
+    }
+
+    void pop_back() noexcept {
+        if (m_size == 0) return;
+        alloc_traits::destroy(m_heap, m_data + --m_size);
+    }
+    // pops min(count, size()) elements
+    void pop_back_n(size_t count) noexcept {
+        if (count > m_size) count = m_size;
+        if (std::is_trivially_destructible<T>::value)
+            m_size -= count;
+        else
+            while (count--) pop_back();
+    }
+    void clear() noexcept { pop_back_n(m_size); }
+
+    void reserve(size_t capacity) {
+        if (capacity <= m_capacity) return;
+        const pointer buffer = alloc_traits::allocate(m_heap, capacity);
+        try {
+            relocate(m_data, m_size, buffer);
+        } catch (...) {
+            alloc_traits::deallocate(m_heap, buffer, capacity);
+            throw;
+        }
+        adopt(buffer, capacity);
+    }
+
+    reference operator[](size_t index) noexcept { return m_data[index]; }
+    const_reference operator[](size_t index) const noexcept { return m_data[index]; }
+    reference front() noexcept { return m_data[0]; }
+    const_reference front() const noexcept { return m_data[0]; }
+    reference back() noexcept { return m_data[m_size - 1]; }
+    const_reference back() const noexcept { return m_data[m_size - 1]; }
+
+    pointer data() noexcept { return m_data; }
+    const T* data() const noexcept { return m_data; }
+
+    iterator begin() noexcept { return m_data; }
+    iterator end() noexcept { return m_data + m_size; }
+    const_iterator begin() const noexcept { return m_data; }
+    const_iterator end() const noexcept { return m_data + m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+    size_t size() const noexcept { return m_size; }
+    size_t capacity() const noexcept { return m_capacity; }
+    static constexpr size_t inline_capacity() noexcept { return N; }
+    bool is_inline() const noexcept { return m_data == inline_data(); }
+
+    allocator_type get_allocator() const { return allocator_type(m_heap); }
+
+    static small_spill_stats& spill_stats() noexcept {
+        static small_spill_stats stats;
+        return stats;
+    }
+
+    void swap(Small_vector& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        if (this == &other) return;
+        if (!is_inline() && !other.is_inline()) {
+            using std::swap;
+            if (alloc_traits::propagate_on_container_swap::value)
+                swap(static_cast<alloc_type&>(m_heap), static_cast<alloc_type&>(other.m_heap));
+            swap(m_data, other.m_data);
+            swap(m_size, other.m_size);
+            swap(m_capacity, other.m_capacity);
+            return;
+        }
+        Small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    static constexpr bool relocatable = inplace_trivially_relocatable<T>::value;
+
+    // allocator is empty base for std::allocator
+    struct heap_t : alloc_type {
+        heap_t() = default;
+        heap_t(const alloc_type& alloc) : alloc_type(alloc) {}
+    };
+
+    pointer inline_data() noexcept { return reinterpret_cast<pointer>(m_inline); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(m_inline); }
+
+    // moves 'count' elements to uninitialized 'out', sources are destroyed
+    void relocate(pointer from, size_t count, pointer out) {
+        if (relocatable) {
+            if (count) std::memcpy(static_cast<void*>(out), from, count * sizeof(T));
+            return;
+        }
+        size_t i = 0;
+        try {
+            for (; i < count; i++)
+                alloc_traits::construct(m_heap, out + i, std::move_if_noexcept(from[i]));
+        } catch (...) {
+            while (i--) alloc_traits::destroy(m_heap, out + i);
+            throw;
+        }
+        for (i = 0; i < count; i++)
+            alloc_traits::destroy(m_heap, from + i);
+    }
+
+    // sets heap buffer with already relocated elements
+    void adopt(pointer buffer, size_t capacity) noexcept {
+        small_spill_stats& stats = spill_stats();
+        if (is_inline()) stats.spills.fetch_add(1, std::memory_order_relaxed);
+        else stats.grows.fetch_add(1, std::memory_order_relaxed);
+        size_t peak = stats.peak.load(std::memory_order_relaxed);
+        while (peak < capacity && !stats.peak.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {}
+
+        release();
+        m_data = buffer;
+        m_capacity = capacity;
+    }
+
+    void release() noexcept {
+        if (!is_inline())
+            alloc_traits::deallocate(m_heap, m_data, m_capacity);
+        m_data = inline_data();
+        m_capacity = N;
+    }
+
+    template <typename... Args>
+    reference grow_emplace(Args&&... args) {
+        // new element is constructed first, 'args' can refer to old elements
+        const size_t capacity = m_capacity * 2;
+        const pointer buffer = alloc_traits::allocate(m_heap, capacity);
+        try {
+            alloc_traits::construct(m_heap, buffer + m_size, std::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(m_heap, buffer, capacity);
+            throw;
+        }
+        try {
+            relocate(m_data, m_size, buffer);
+        } catch (...) {
+            alloc_traits::destroy(m_heap, buffer + m_size);
+            alloc_traits::deallocate(m_heap, buffer, capacity);
+            throw;
+        }
+        adopt(buffer, capacity);
+        return m_data[m_size++];
+    }
+
+    // 'other' is empty and inline after, allocator is already moved
+    void take(Small_vector& other)
+    noexcept(relocatable || std::is_nothrow_move_constructible<T>::value) {
+        if (other.is_inline()) {
+            relocate(other.m_data, other.m_size, m_data);
+        } else {
+            m_data = other.m_data;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inline_data();
+            other.m_capacity = N;
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+
+private:
+    alignas(T) char m_inline[N * sizeof(T)];
+    heap_t m_heap;
+    pointer m_data = inline_data();
+    size_t m_size = 0;
+    size_t m_capacity = N;
+}; // class Small_vector
+
+template <typename T, size_t N, typename Allocator>
+class Small_stack {
+    using vector_type = Small_vector<T, N, Allocator>;
+
+public:
+    using value_type     = T;
+    using allocator_type = Allocator;
+    using pointer        = T*;
+    using reference      = T&;
+    using const_reference = const T&;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+public:
+    Small_stack() = default;
+    explicit Small_stack(const Allocator& alloc) noexcept : m_data(alloc) {}
+    Small_stack(std::initializer_list<T> il, const Allocator& alloc = Allocator()) : m_data(il, alloc) {}
+
+    void push(const T& new_value) { m_data.push_back(new_value); }
+    void push(T&& new_value) { m_data.push_back(std::move(new_value)); }
+
+    // nullptr only if allocation of heap buffer failed
+    pointer try_push(const T& new_value) { return try_emplace(new_value); }
+    pointer try_push(T&& new_value) { return try_emplace(std::move(new_value)); }
+
+    template <typename... Args>
+    reference emplace(Args&&... args) {
+        return m_data.emplace_back(std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    pointer try_emplace(Args&&... args) {
+        try {
+            return &m_data.emplace_back(std::forward<Args>(args)...);
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    template <typename It>
+    void push_range(It first, It last) { m_data.append(first, last); }
+    template <typename It>
+    bool try_push_range(It first, It last) {
+        try {
+            m_data.append(first, last);
+            return true;
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+    }
+
+    void pop() noexcept { m_data.pop_back(); }
+    void pop_n(size_t count) noexcept { m_data.pop_back_n(count); }
+
+    reference top() noexcept { return m_data.back(); }
+    const_reference top() const noexcept { return m_data.back(); }
+
+    pointer data() noexcept { return m_data.data(); }
+    const T* data() const noexcept { return m_data.data(); }
+
+    // live elements from bottom to top
+    iterator begin() noexcept { return m_data.begin(); }
+    iterator end() noexcept { return m_data.end(); }
+    const_iterator begin() const noexcept { return m_data.begin(); }
+    const_iterator end() const noexcept { return m_data.end(); }
+
+    bool empty() const noexcept { return m_data.empty(); }
+    size_t size() const noexcept { return m_data.size(); }
+    size_t capacity() const noexcept { return m_data.capacity(); }
+    void reserve(size_t capacity) { m_data.reserve(capacity); }
+    static constexpr size_t inline_capacity() noexcept { return N; }
+    bool is_inline() const noexcept { return m_data.is_inline(); }
+
+    static small_spill_stats& spill_stats() noexcept { return vector_type::spill_stats(); }
+
+    void swap(Small_stack& other) noexcept(noexcept(std::declval<vector_type&>().swap(std::declval<vector_type&>()))) {
+        m_data.swap(other.m_data);
+    }
+
+private:
+    vector_type m_data;
+}; // class Small_stack
+
+} // namespace impl
+
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+using small_vector = impl::Small_vector<T, N, Allocator>;
+
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+using small_stack = impl::Small_stack<T, N, Allocator>;
+
+namespace std {
+    template <typename T, size_t N, typename Allocator>
+    void swap(impl::Small_vector<T, N, Allocator>& a, impl::Small_vector<T, N, Allocator>& b)
+    noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    template <typename T, size_t N, typename Allocator>
+    void swap(impl::Small_stack<T, N, Allocator>& a, impl::Small_stack<T, N, Allocator>& b)
+    noexcept(noexcept(a.swap(b))) { a.swap(b); }
+}
+
+#endif // SMALL_STACK_HPP
@@ -0,0 +1,156 @@
+/*
+Counter-based pseudo-random number generator based on
+algorithm SplitMix64 with 64-bit result,
+C++11 and later
+
+Value number i depends only on seed, stream and i:
+  splitmix(seed, stream).at(i)
+so work can be partitioned across threads or processes
+without coordination by giving each one own stream or
+own range of indices
+*/
+
+#ifndef SPLITMIX_PRNG_HPP
+#define SPLITMIX_PRNG_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include <ostream>
+#include <istream>
+
+class splitmix {
+public:
+    using result_type = uint_fast64_t;
+    static constexpr result_type default_seed = 1;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    splitmix() { seed(); }
+    splitmix(result_type s) { seed(s); }
+    splitmix(result_type s, result_type stream_id) { seed(s, stream_id); }
+    template <class SeedSeq, class = typename std::enable_if<
+        !std::is_same<SeedSeq, splitmix>::value>::type>
+    splitmix(SeedSeq& q) { seed(q); }
+
+    void seed() { seed(default_seed); }
+    void seed(result_type s) {
+        m_key     = mix64(s);
+        m_gamma   = golden_gamma;
+        m_counter = 0;
+    }
+    void seed(result_type s, result_type stream_id) {
+        seed(s);
+        *this = stream(stream_id);
+    }
+    template <class SeedSeq>
+    void seed(SeedSeq& q) {
+        uint_least32_t sa[4] {};
+        q.generate(sa, sa + 4);
+        seed(uint64_t(sa[1] & UINT32_MAX) << 32 | (sa[0] & UINT32_MAX),
+             uint64_t(sa[3] & UINT32_MAX) << 32 | (sa[2] & UINT32_MAX));
+    }
+
+    result_type operator()() { return at(m_counter++); }
+
+    // random access to value number 'index', does not change state
+    result_type at(unsigned long long index) const {
+        return mix64(m_key + (uint64_t(index) + 1) * m_gamma);
+    }
+
+    void discard(unsigned long long count) { m_counter += count; }
+    void seek(unsigned long long index) { m_counter = index; }
+    unsigned long long position() const { return m_counter; }
+
+    // independent generator for 'stream_id', does not change state
+    splitmix stream(result_type stream_id) const {
+        const uint64_t id = mix64(uint64_t(stream_id) + golden_gamma);
+        return from_key(mix64(m_key ^ id), mix_gamma(m_gamma + id));
+    }
+
+    // new independent generator, advances state by two values
+    splitmix split() {
+        const uint64_t key = operator()();
+        return from_key(mix64(key), mix_gamma(operator()()));
+    }
+
+    bool operator==(const splitmix& rhs) const {
+        return m_key == rhs.m_key
+            && m_gamma == rhs.m_gamma
+            && m_counter == rhs.m_counter;
+    }
+    bool operator!=(const splitmix& rhs) const {
+        return !(*this == rhs);
+    }
+
+    template <class CharT, class Traits>
+    friend std::basic_ostream<CharT, Traits>&
+    operator<<(std::basic_ostream<CharT, Traits>& os, const splitmix& smg) {
+        using ios_base = typename std::basic_ostream<CharT, Traits>::ios_base;
+
+        const typename ios_base::fmtflags flags = os.flags();
+        const CharT prevfill = os.fill(os.widen(' '));
+        os.flags(ios_base::dec | ios_base::left);
+
+        const CharT space = os.widen(' ');
+        os << smg.m_key << space << smg.m_gamma << space << smg.m_counter;
+
+        os.flags(flags);
+        os.fill(prevfill);
+        return os;
+    }
+
+    template <class CharT, class Traits>
+    friend std::basic_istream<CharT, Traits>&
+    operator>>(std::basic_istream<CharT, Traits>& is, splitmix& smg) {
+        using ios_base = typename std::basic_istream<CharT, Traits>::ios_base;
+
+        const typename ios_base::fmtflags flags = is.flags();
+        is.flags(ios_base::dec | ios_base::skipws);
+
+        uint64_t key, gamma;
+        unsigned long long counter;
+        if (is >> key >> gamma >> counter) {
+            smg.m_key     = key;
+            smg.m_gamma   = gamma | 1;
+            smg.m_counter = counter;
+        }
+
+        is.flags(flags);
+        return is;
+    }
+
+private:
+    static constexpr uint64_t golden_gamma = UINT64_C(0x9e3779b97f4a7c15);
+
+    static splitmix from_key(uint64_t key, uint64_t gamma) {
+        splitmix out;
+        out.m_key   = key;
+        out.m_gamma = gamma;
+        return out;
+    }
+
+    static uint64_t mix64(uint64_t z) {
+        z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31);
+    }
+
+    // odd increment with enough bit transitions to be a good step
+    static uint64_t mix_gamma(uint64_t z) {
+        z = (z ^ (z >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+        z = (z ^ (z >> 33)) * UINT64_C(0xc4ceb9fe1a85ec53);
+        z = (z ^ (z >> 33)) | 1;
+
+        uint64_t flips = z ^ (z >> 1);
+        unsigned count = 0;
+        for (; flips; flips &= flips - 1) count++;
+        return count < 24 ? z ^ UINT64_C(0xaaaaaaaaaaaaaaaa) : z;
+    }
+
+    uint64_t m_key;
+    uint64_t m_gamma;
+    unsigned long long m_counter;
+};
+
+#endif // SPLITMIX_PRNG_HPP
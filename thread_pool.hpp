@@ -0,0 +1,267 @@
+/* Work-stealing thread pool in C++14 and later */
+/*
+  thread_pool pool;                      // hardware_concurrency() - 1 workers
+  pool.parallel_for(0, chunks, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++)
+          digests[i] = sha256_data(data + i * chunk, chunk_size(i));
+  });
+
+Tasks are intrusive (thread_pool::task), caller owns their memory, so
+submit and execution do not allocate. Every worker has own inplace_ws_deque:
+  submit from worker    - push to own deque (run at once if full)
+  submit from other     - push to shared inplace_mpmc_queue (run at once if full)
+  idle worker           - pop own deque, pop shared queue, steal from
+                          random victim chosen by own xorshift
+wait(task) executes other tasks until task is done, so waiting threads
+help instead of blocking and fork-join does not deadlock.
+*/
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "inplace_deque.hpp"
+#include "inplace_queue.hpp"
+#include "xorshift.hpp"
+
+class thread_pool {
+public:
+    static constexpr size_t deque_capacity  = 1024;
+    static constexpr size_t shared_capacity = 1024;
+
+    struct task {
+        void (*execute)(task&) = nullptr;
+        std::exception_ptr error;       // set if execute threw, rethrown by wait
+        std::atomic<bool> done {false};
+
+        task() = default;
+        explicit task(void (*fn)(task&)) noexcept : execute(fn) {}
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+    };
+
+public:
+    // 0 workers is valid, then all tasks run in threads calling wait
+    explicit thread_pool(size_t workers = default_workers())
+    : m_workers(workers), m_count(workers) {
+        for (size_t i = 0; i < m_count; i++)
+            m_workers[i].victims.seed(UINT64_C(0x9e3779b97f4a7c15) * (i + 1));
+        for (size_t i = 0; i < m_count; i++)
+            m_workers[i].thread = std::thread(&thread_pool::worker_loop, this, i);
+    }
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop.store(true, std::memory_order_release);
+        }
+        m_wake.notify_all();
+        for (size_t i = 0; i < m_count; i++)
+            m_workers[i].thread.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    static size_t default_workers() noexcept {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+    size_t size() const noexcept { return m_count; }
+
+    // 't' must live until it is done, see wait
+    void submit(task& t) {
+        t.done.store(false, std::memory_order_relaxed);
+        t.error = nullptr;
+        worker_t* self = current();
+        const bool queued = self && self->pool == this
+            ? self->tasks.try_push(&t)
+            : m_shared.try_push(&t);
+        if (!queued) {
+            run(t);
+            return;
+        }
+        if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+            m_wake.notify_one();
+    }
+
+    // runs other tasks until 't' is done, rethrows its exception
+    void wait(task& t) {
+        worker_t* self = current();
+        if (self && self->pool != this) self = nullptr;
+        xorshift local(reinterpret_cast<uintptr_t>(&t) | 1);
+        xorshift& victims = self ? self->victims : local;
+
+        while (!t.done.load(std::memory_order_acquire)) {
+            task* other = find_task(self, victims);
+            if (other) run(*other);
+            else std::this_thread::yield();
+        }
+        if (t.error)
+            std::rethrow_exception(t.error);
+    }
+
+    // calls fn(first, last) for subranges of [begin, end) not longer than 'grain',
+    // range is split in halves, right half is offered to other workers
+    template <typename Fn>
+    void parallel_for(size_t begin, size_t end, size_t grain, Fn&& fn) {
+        if (grain == 0) grain = 1;
+        split(begin, end, grain, fn);
+    }
+
+private:
+    struct worker_t {
+        thread_pool* pool = nullptr;
+        std::thread thread;
+        xorshift victims;
+        impl::Inplace_ws_deque<task*, deque_capacity> tasks;
+    };
+
+    // worker_t is over-aligned (deque indices on own cache lines),
+    // new[] respects that only since C++17, so storage is aligned by hand
+    class worker_array {
+    public:
+        explicit worker_array(size_t count)
+        : m_raw(::operator new(count * sizeof(worker_t) + alignof(worker_t))) {
+            const uintptr_t raw = reinterpret_cast<uintptr_t>(m_raw);
+            m_data = reinterpret_cast<worker_t*>((raw + alignof(worker_t) - 1) & ~(alignof(worker_t) - 1));
+            try {
+                for (; m_size < count; m_size++)
+                    new (m_data + m_size) worker_t();
+            } catch (...) {
+                destroy();
+                throw;
+            }
+        }
+        ~worker_array() { destroy(); }
+
+        worker_array(const worker_array&) = delete;
+        worker_array& operator=(const worker_array&) = delete;
+
+        worker_t& operator[](size_t index) noexcept { return m_data[index]; }
+
+    private:
+        void destroy() noexcept {
+            while (m_size > 0)
+                m_data[--m_size].~worker_t();
+            ::operator delete(m_raw);
+        }
+
+        void* m_raw;
+        worker_t* m_data;
+        size_t m_size = 0;
+    };
+
+    template <typename Fn>
+    struct range_task : task {
+        thread_pool* pool;
+        Fn* fn;
+        size_t begin, end, grain;
+
+        range_task(thread_pool* p, Fn* f, size_t b, size_t e, size_t g) noexcept
+        : task(&range_task::execute_range), pool(p), fn(f), begin(b), end(e), grain(g) {}
+
+        static void execute_range(task& t) {
+            range_task& r = static_cast<range_task&>(t);
+            r.pool->split(r.begin, r.end, r.grain, *r.fn);
+        }
+    };
+
+    template <typename Fn>
+    void split(size_t begin, size_t end, size_t grain, Fn& fn) {
+        while (end - begin > grain) {
+            const size_t mid = begin + (end - begin) / 2;
+            range_task<Fn> right(this, &fn, mid, end, grain);
+            submit(right);
+            try {
+                split(begin, mid, grain, fn);
+            } catch (...) {
+                // 'right' lives on this stack frame, it must finish before unwinding
+                try { wait(right); } catch (...) {}
+                throw;
+            }
+            wait(right);
+            return;
+        }
+        if (begin < end)
+            fn(begin, end);
+    }
+
+    static worker_t*& current() noexcept {
+        static thread_local worker_t* self = nullptr;
+        return self;
+    }
+
+    static void run(task& t) noexcept {
+        try {
+            t.execute(t);
+        } catch (...) {
+            t.error = std::current_exception();
+        }
+        t.done.store(true, std::memory_order_release);
+    }
+
+    task* find_task(worker_t* self, xorshift& victims) noexcept {
+        task* out = nullptr;
+        if (self && self->tasks.try_pop(out)) return out;
+        if (m_shared.try_pop(out)) return out;
+        if (m_count == 0) return nullptr;
+
+        const size_t first = static_cast<size_t>(victims() % m_count);
+        for (size_t i = 0; i < m_count; i++) {
+            worker_t& victim = m_workers[(first + i) % m_count];
+            if (&victim != self && victim.tasks.try_steal(out))
+                return out;
+        }
+        return nullptr;
+    }
+
+    void worker_loop(size_t index) {
+        worker_t& self = m_workers[index];
+        self.pool = this;
+        current() = &self;
+
+        constexpr unsigned spins_before_sleep = 64;
+        unsigned idle = 0;
+        while (!m_stop.load(std::memory_order_acquire)) {
+            if (task* t = find_task(&self, self.victims)) {
+                run(*t);
+                idle = 0;
+                continue;
+            }
+            if (++idle < spins_before_sleep) {
+                std::this_thread::yield();
+                continue;
+            }
+            // timeout bounds lost wakeup between check and sleep
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_stop.load(std::memory_order_acquire) && m_shared.empty_approx())
+                m_wake.wait_for(lock, std::chrono::milliseconds(1));
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+            idle = 0;
+        }
+        current() = nullptr;
+    }
+
+private:
+    worker_array m_workers;
+    size_t m_count;
+    impl::Inplace_mpmc_queue<task*, shared_capacity> m_shared;
+
+    std::atomic<bool> m_stop {false};
+    std::atomic<size_t> m_sleeping {0};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+};
+
+#endif // THREAD_POOL_HPP
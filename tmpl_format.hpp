@@ -0,0 +1,347 @@
+/* C++20 and later, printf-style formatting compiled at compile time from basic_tmpl_string */
+/*
+  using line = tmpl_format<"user=%-8.8s id=%06u rc=%d">;
+  char buf[line::max_size<const char*, unsigned, int>()];
+  size_t n = line::format_to(buf, name, id, rc);
+
+Format string is parsed at compile time into fixed sequence of steps:
+literal copy (memcpy with constant length) or conversion of one argument.
+Each call runs these steps without parsing, allocation or locale.
+Output always ends with null, max_size counts it.
+
+Specifier: %[flags][width][.precision][length]conversion
+  flags       - '-' left align, '0' zero padding, '+' sign always
+  width       - decimal number
+  precision   - maximum length for %s (required for unbounded strings)
+  length      - hh, h, l, ll, j, z, t accepted and ignored,
+                size is taken from argument type
+  conversion  - d i u x X o c s p %
+*/
+#ifndef TMPL_FORMAT_HPP
+#define TMPL_FORMAT_HPP
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+
+#include "tmpl_string.hpp"
+
+namespace detail {
+    struct fmt_step {
+        bool   is_literal = true;
+        size_t offset = 0;    // literal: position in format string
+        size_t length = 0;    // literal: count of chars
+        char   conv = 0;
+        bool   left = false;
+        bool   zero = false;
+        bool   plus = false;
+        size_t width = 0;
+        size_t precision = size_t(-1);
+        size_t arg_index = 0;
+    };
+
+    constexpr bool fmt_is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+    // parse specifier started after '%' at 'pos', result ends at 'pos'
+    constexpr fmt_step fmt_parse_spec(std::string_view fmt, size_t& pos) {
+        fmt_step step;
+        step.is_literal = false;
+        for (; pos < fmt.size(); pos++) {
+            if (fmt[pos] == '-') step.left = true;
+            else if (fmt[pos] == '0') step.zero = true;
+            else if (fmt[pos] == '+') step.plus = true;
+            else break;
+        }
+        for (; pos < fmt.size() && fmt_is_digit(fmt[pos]); pos++)
+            step.width = step.width * 10 + size_t(fmt[pos] - '0');
+        if (pos < fmt.size() && fmt[pos] == '.') {
+            step.precision = 0;
+            for (pos++; pos < fmt.size() && fmt_is_digit(fmt[pos]); pos++)
+                step.precision = step.precision * 10 + size_t(fmt[pos] - '0');
+        }
+        for (; pos < fmt.size(); pos++) {
+            const char c = fmt[pos];
+            if (c != 'h' && c != 'l' && c != 'j' && c != 'z' && c != 't') break;
+        }
+        if (pos == fmt.size())
+            throw "tmpl_format: unterminated conversion specifier";
+
+        step.conv = fmt[pos++];
+        switch (step.conv) {
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            case 'c': case 's': case 'p': break;
+            default: throw "tmpl_format: unknown conversion specifier";
+        }
+        if (step.left) step.zero = false;
+        return step;
+    }
+
+    // calls 'out(step)' for every step, returns count of steps
+    template <typename Out>
+    constexpr size_t fmt_parse(std::string_view fmt, Out out) {
+        size_t count = 0, args = 0, pos = 0;
+        while (pos < fmt.size()) {
+            const size_t start = pos;
+            while (pos < fmt.size() && fmt[pos] != '%') pos++;
+
+            // "%%" ends literal with first '%' and skips second
+            const bool escaped = pos + 1 < fmt.size() && fmt[pos + 1] == '%';
+            const size_t end = escaped ? pos + 1 : pos;
+            if (end > start) {
+                fmt_step lit;
+                lit.offset = start;
+                lit.length = end - start;
+                out(count++, lit);
+            }
+            if (escaped) {
+                pos += 2;
+                continue;
+            }
+            if (pos == fmt.size()) break;
+            pos++; // '%'
+            fmt_step spec = fmt_parse_spec(fmt, pos);
+            spec.arg_index = args++;
+            out(count++, spec);
+        }
+        return count;
+    }
+
+    template <typename T>
+    using fmt_plain = std::remove_cvref_t<std::decay_t<T>>;
+
+    template <typename T> struct fmt_is_tmpl_string : std::false_type {};
+    template <size_t N, typename Traits>
+    struct fmt_is_tmpl_string<basic_tmpl_string<N, char, Traits>> : std::true_type {
+        static constexpr size_t bound = N - 1;
+    };
+
+    template <typename T>
+    constexpr bool fmt_is_cstring = std::is_same_v<fmt_plain<T>, const char*>
+                                 || std::is_same_v<fmt_plain<T>, char*>;
+
+    template <typename T>
+    constexpr bool fmt_is_string = fmt_is_cstring<T>
+        || std::is_convertible_v<const T&, std::string_view>
+        || fmt_is_tmpl_string<std::remove_cvref_t<T>>::value;
+
+    template <typename T>
+    constexpr size_t fmt_int_digits(unsigned base) {
+        using U = std::make_unsigned_t<T>;
+        size_t out = 1;
+        for (U n = std::numeric_limits<U>::max(); n >= base; n /= base) out++;
+        return out;
+    }
+
+    // longest output of one conversion of argument type T
+    template <typename T>
+    constexpr size_t fmt_max_size(const fmt_step& step) {
+        using P = fmt_plain<T>;
+        size_t n = 0;
+        switch (step.conv) {
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                if constexpr (std::is_integral_v<P> || std::is_enum_v<P>) {
+                    using I = std::conditional_t<std::is_enum_v<P>, std::underlying_type<P>, std::type_identity<P>>;
+                    using V = std::conditional_t<std::is_same_v<typename I::type, bool>, unsigned char, typename I::type>;
+                    if (step.conv == 'c') n = 1;
+                    else if (step.conv == 'x' || step.conv == 'X') n = fmt_int_digits<V>(16);
+                    else if (step.conv == 'o') n = fmt_int_digits<V>(8);
+                    else n = fmt_int_digits<V>(10) + 1; // sign
+                } else throw "tmpl_format: integer conversion needs integral argument";
+                break;
+            case 's':
+                if constexpr (fmt_is_tmpl_string<std::remove_cvref_t<T>>::value) {
+                    n = fmt_is_tmpl_string<std::remove_cvref_t<T>>::bound;
+                    if (step.precision < n) n = step.precision;
+                } else if constexpr (fmt_is_string<T>) {
+                    if (step.precision == size_t(-1))
+                        throw "tmpl_format: %s of unbounded string needs precision, as %.16s";
+                    n = step.precision;
+                } else throw "tmpl_format: %s needs string argument";
+                break;
+            case 'p':
+                if constexpr (std::is_pointer_v<P> || std::is_null_pointer_v<P>)
+                    n = 2 + 2 * sizeof(void*);
+                else throw "tmpl_format: %p needs pointer argument";
+                break;
+        }
+        return n < step.width ? step.width : n;
+    }
+
+    inline char* fmt_pad(char* out, size_t count, char fill) {
+        std::memset(out, fill, count);
+        return out + count;
+    }
+
+    template <fmt_step Step>
+    char* fmt_write_digits(char* out, char sign, const char* digits, size_t count) {
+        const size_t body = count + (sign ? 1 : 0);
+        const size_t pad = Step.width > body ? Step.width - body : 0;
+        if (!Step.left && !Step.zero) out = fmt_pad(out, pad, ' ');
+        if (sign) *out++ = sign;
+        if (Step.zero) out = fmt_pad(out, pad, '0');
+        std::memcpy(out, digits, count);
+        out += count;
+        if (Step.left) out = fmt_pad(out, pad, ' ');
+        return out;
+    }
+
+    template <fmt_step Step, typename U>
+    char* fmt_write_unsigned(char* out, char sign, U value) {
+        constexpr unsigned base = Step.conv == 'x' || Step.conv == 'X' ? 16
+                                : Step.conv == 'o' ? 8 : 10;
+        constexpr const char* alphabet = Step.conv == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+        char tmp[std::numeric_limits<U>::digits + 1];
+        char* end = tmp + sizeof tmp;
+        char* pos = end;
+        do {
+            *--pos = alphabet[value % base];
+            value /= base;
+        } while (value != 0);
+        return fmt_write_digits<Step>(out, sign, pos, size_t(end - pos));
+    }
+
+    template <fmt_step Step>
+    char* fmt_write_chars(char* out, const char* data, size_t count) {
+        const size_t pad = Step.width > count ? Step.width - count : 0;
+        if (!Step.left) out = fmt_pad(out, pad, ' ');
+        std::memcpy(out, data, count);
+        out += count;
+        if (Step.left) out = fmt_pad(out, pad, ' ');
+        return out;
+    }
+
+    template <fmt_step Step, typename T>
+    char* fmt_write_arg(char* out, const T& arg) {
+        using P = fmt_plain<T>;
+        if constexpr (Step.conv == 's') {
+            if constexpr (fmt_is_cstring<T>) {
+                const char* str = arg;
+                size_t n = 0;
+                if (str) while (n < Step.precision && str[n] != '\0') n++;
+                return fmt_write_chars<Step>(out, str, n);
+            } else if constexpr (fmt_is_tmpl_string<std::remove_cvref_t<T>>::value) {
+                const size_t n = arg.size() < Step.precision ? arg.size() : Step.precision;
+                return fmt_write_chars<Step>(out, arg.data(), n);
+            } else {
+                const std::string_view sv(arg);
+                const size_t n = sv.size() < Step.precision ? sv.size() : Step.precision;
+                return fmt_write_chars<Step>(out, sv.data(), n);
+            }
+        } else if constexpr (Step.conv == 'p') {
+            char tmp[2 + 2 * sizeof(void*)];
+            char* end = tmp + sizeof tmp;
+            char* pos = end;
+            uintptr_t value = reinterpret_cast<uintptr_t>(arg);
+            do {
+                *--pos = "0123456789abcdef"[value & 15];
+                value >>= 4;
+            } while (value != 0);
+            *--pos = 'x';
+            *--pos = '0';
+            return fmt_write_chars<Step>(out, pos, size_t(end - pos));
+        } else if constexpr (Step.conv == 'c') {
+            const char c = static_cast<char>(arg);
+            return fmt_write_chars<Step>(out, &c, 1);
+        } else {
+            using I = typename std::conditional_t<std::is_enum_v<P>, std::underlying_type<P>, std::type_identity<P>>::type;
+            using V = std::conditional_t<std::is_same_v<I, bool>, unsigned char, I>;
+            using U = std::make_unsigned_t<V>;
+            const V value = static_cast<V>(arg);
+            if constexpr ((Step.conv == 'd' || Step.conv == 'i') && std::is_signed_v<V>) {
+                const U mag = value < 0 ? U(0) - static_cast<U>(value) : static_cast<U>(value);
+                const char sign = value < 0 ? '-' : Step.plus ? '+' : 0;
+                return fmt_write_unsigned<Step>(out, sign, mag);
+            } else {
+                const char sign = (Step.conv == 'd' || Step.conv == 'i') && Step.plus ? '+' : 0;
+                return fmt_write_unsigned<Step>(out, sign, static_cast<U>(value));
+            }
+        }
+    }
+}
+
+template <basic_tmpl_string Fmt>
+class tmpl_format {
+    static_assert(std::is_same_v<typename decltype(Fmt)::value_type, char>,
+        "tmpl_format supports only char format strings");
+
+    static constexpr std::string_view format{Fmt.data(), Fmt.size()};
+
+    static constexpr size_t step_count = detail::fmt_parse(format, [](size_t, const detail::fmt_step&) {});
+
+    static constexpr auto steps = [] {
+        struct { detail::fmt_step items[step_count ? step_count : 1]; } out {};
+        detail::fmt_parse(format, [&](size_t i, const detail::fmt_step& s) { out.items[i] = s; });
+        return out;
+    }();
+
+    static constexpr size_t count_args() {
+        size_t out = 0;
+        for (size_t i = 0; i < step_count; i++)
+            out += !steps.items[i].is_literal;
+        return out;
+    }
+
+    template <typename Tuple, size_t... I>
+    static constexpr size_t max_size_impl(std::index_sequence<I...>) {
+        size_t out = 1; // null
+        ((out += steps.items[I].is_literal ? steps.items[I].length
+            : detail::fmt_max_size<std::tuple_element_t<
+                steps.items[I].is_literal ? 0 : steps.items[I].arg_index, Tuple>>(steps.items[I])), ...);
+        return out;
+    }
+
+    // variable forces constant evaluation, so errors are not deferred to VLA bound
+    template <typename... Args>
+    static constexpr size_t max_size_v = max_size_impl<std::tuple<Args..., void*>>(std::make_index_sequence<step_count>{});
+
+    template <size_t I, typename Tuple>
+    static char* run_step(char* out, const Tuple& args) {
+        constexpr detail::fmt_step step = steps.items[I];
+        if constexpr (step.is_literal) {
+            std::memcpy(out, format.data() + step.offset, step.length);
+            return out + step.length;
+        } else {
+            return detail::fmt_write_arg<step>(out, std::get<step.arg_index>(args));
+        }
+    }
+
+    template <typename Tuple, size_t... I>
+    static char* run(char* out, const Tuple& args, std::index_sequence<I...>) {
+        ((out = run_step<I>(out, args)), ...);
+        return out;
+    }
+
+public:
+    static constexpr size_t arg_count = count_args();
+
+    // longest output with null for arguments of types Args
+    template <typename... Args>
+    static constexpr size_t max_size() {
+        static_assert(sizeof...(Args) == arg_count, "Count of arguments not equal count of specifiers");
+        return max_size_v<Args...>;
+    }
+
+    // returns count of written chars without null
+    template <size_t M, typename... Args>
+    static size_t format_to(char (&buffer)[M], const Args&... args) {
+        static_assert(M >= max_size<Args...>(), "Buffer is less than tmpl_format::max_size");
+        return format_to_unchecked(buffer, args...);
+    }
+
+    // 'buffer' must have at least max_size<Args...>() chars
+    template <typename... Args>
+    static size_t format_to_unchecked(char* buffer, const Args&... args) {
+        static_assert(sizeof...(Args) == arg_count, "Count of arguments not equal count of specifiers");
+        const auto tuple = std::forward_as_tuple(args...);
+        char* end = run(buffer, tuple, std::make_index_sequence<step_count>{});
+        *end = '\0';
+        return size_t(end - buffer);
+    }
+};
+
+#endif // TMPL_FORMAT_HPP
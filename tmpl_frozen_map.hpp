@@ -0,0 +1,234 @@
+/* C++20 and later, compile-time perfect hash set/map with basic_tmpl_string keys */
+/*
+  using commands = tmpl_frozen_map<handler_t, "get", "put", "delete">;
+  constexpr commands table {on_get, on_put, on_delete};
+  if (auto h = table.find(name)) (*h)(args);
+  commands copy(table);                          // copyable as usual
+
+Table is built at compile time (hash and displace):
+  h      = FNV-1a 64 of key with seed
+  bucket = h % buckets
+  slot   = mix(h, displacement[bucket]) % slots
+seed and displacements are searched so every key gets own slot,
+runtime lookup is one hash, one compare and no allocation
+*/
+#ifndef TMPL_FROZEN_MAP_HPP
+#define TMPL_FROZEN_MAP_HPP
+
+#include <string_view>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "tmpl_string.hpp"
+
+namespace detail {
+    constexpr size_t frozen_bit_ceil(size_t n) noexcept {
+        size_t out = 1;
+        while (out < n) out <<= 1;
+        return out;
+    }
+
+    // FNV-1a 64 over code units in little-endian byte order
+    template <typename CharT>
+    constexpr uint64_t frozen_hash(const CharT* data, size_t size, uint64_t seed) noexcept {
+        using uchar_t = std::make_unsigned_t<CharT>;
+        uint64_t h = UINT64_C(0xcbf29ce484222325) ^ seed;
+        for (size_t i = 0; i < size; i++) {
+            const uchar_t c = static_cast<uchar_t>(data[i]);
+            for (size_t b = 0; b < sizeof(CharT); b++) {
+                h ^= static_cast<uint8_t>(c >> (8 * b));
+                h *= UINT64_C(0x100000001b3);
+            }
+        }
+        return h;
+    }
+
+    constexpr uint64_t frozen_mix(uint64_t h, uint64_t d) noexcept {
+        h ^= d * UINT64_C(0x9e3779b97f4a7c15);
+        h = (h ^ (h >> 33)) * UINT64_C(0xff51afd7ed558ccd);
+        return h ^ (h >> 33);
+    }
+
+    template <size_t Count>
+    struct frozen_table {
+        static constexpr size_t buckets = frozen_bit_ceil(Count / 2 + 1);
+        static constexpr size_t slots   = frozen_bit_ceil(Count + Count / 3 + 1);
+
+        uint64_t seed = 0;
+        uint32_t displacement[buckets] {};
+        uint32_t slot_key[slots] {}; // key index + 1, 0 is free slot
+    };
+
+    template <typename View, size_t Count>
+    constexpr bool frozen_unique(const View (&keys)[Count]) {
+        for (size_t i = 0; i < Count; i++)
+            for (size_t j = i + 1; j < Count; j++)
+                if (keys[i] == keys[j]) return false;
+        return true;
+    }
+
+    template <typename View, size_t Count>
+    constexpr bool frozen_try_seed(frozen_table<Count>& table, const View (&keys)[Count]) {
+        using table_t = frozen_table<Count>;
+        constexpr uint32_t max_displacement = 1u << 16;
+
+        uint64_t hash[Count] {};
+        size_t bucket_of[Count] {};
+        size_t bucket_size[table_t::buckets] {};
+        size_t order[table_t::buckets] {};
+
+        for (size_t i = 0; i < Count; i++) {
+            hash[i] = frozen_hash(keys[i].data(), keys[i].size(), table.seed);
+            bucket_of[i] = hash[i] & (table_t::buckets - 1);
+            bucket_size[bucket_of[i]]++;
+        }
+
+        // place biggest buckets first while table is empty
+        for (size_t i = 0; i < table_t::buckets; i++) {
+            size_t j = i;
+            for (; j > 0 && bucket_size[order[j - 1]] < bucket_size[i]; j--)
+                order[j] = order[j - 1];
+            order[j] = i;
+        }
+
+        for (size_t b : order) {
+            if (bucket_size[b] == 0) break;
+
+            size_t members[Count] {}, slots[Count] {}, n = 0;
+            for (size_t i = 0; i < Count; i++)
+                if (bucket_of[i] == b) members[n++] = i;
+
+            uint32_t d = 1;
+            for (; d < max_displacement; d++) {
+                bool fits = true;
+                for (size_t i = 0; i < n && fits; i++) {
+                    slots[i] = frozen_mix(hash[members[i]], d) & (table_t::slots - 1);
+                    fits = table.slot_key[slots[i]] == 0;
+                    for (size_t j = 0; j < i && fits; j++)
+                        fits = slots[j] != slots[i];
+                }
+                if (fits) break;
+            }
+            if (d == max_displacement) return false;
+
+            table.displacement[b] = d;
+            for (size_t i = 0; i < n; i++)
+                table.slot_key[slots[i]] = static_cast<uint32_t>(members[i] + 1);
+        }
+        return true;
+    }
+
+    template <typename View, size_t Count>
+    constexpr frozen_table<Count> frozen_build(const View (&keys)[Count]) {
+        for (uint64_t seed = 0;; seed++) {
+            frozen_table<Count> table {};
+            table.seed = seed;
+            if (frozen_try_seed(table, keys))
+                return table;
+        }
+    }
+}
+
+template <basic_tmpl_string... Keys>
+class tmpl_frozen_set {
+    static_assert(sizeof...(Keys) > 0, "tmpl_frozen_set needs at least one key");
+
+    using some_key = std::remove_cvref_t<decltype((Keys, ...))>;
+
+public:
+    using value_type  = typename some_key::value_type;
+    using traits_type = typename some_key::traits_type;
+    using view_type   = std::basic_string_view<value_type, traits_type>;
+    using size_type   = size_t;
+
+    static constexpr size_type npos = size_type(-1);
+
+private:
+    static_assert((std::is_same_v<typename std::remove_cvref_t<decltype(Keys)>::value_type, value_type> && ...),
+        "All keys must have equal char type");
+
+    static constexpr view_type keys[] = { view_type(Keys.data(), Keys.size())... };
+    static_assert(detail::frozen_unique(keys), "Keys of tmpl_frozen_set must be unique");
+
+    static constexpr auto table = detail::frozen_build(keys);
+
+public:
+    static constexpr size_type size() noexcept { return sizeof...(Keys); }
+
+    // index of key in template argument list or npos
+    static constexpr size_type index_of(view_type key) noexcept {
+        using table_t = std::remove_cvref_t<decltype(table)>;
+        const uint64_t h = detail::frozen_hash(key.data(), key.size(), table.seed);
+        const uint32_t d = table.displacement[h & (table_t::buckets - 1)];
+        const uint32_t k = table.slot_key[detail::frozen_mix(h, d) & (table_t::slots - 1)];
+        return k != 0 && keys[k - 1] == key ? k - 1 : npos;
+    }
+
+    static constexpr bool contains(view_type key) noexcept { return index_of(key) != npos; }
+    static constexpr view_type key(size_type index) noexcept { return keys[index]; }
+};
+
+template <typename T, basic_tmpl_string... Keys>
+class tmpl_frozen_map {
+    using set_type = tmpl_frozen_set<Keys...>;
+
+public:
+    using key_type    = typename set_type::view_type;
+    using mapped_type = T;
+    using size_type   = size_t;
+
+public:
+    // one value per key, not viable for copy/move so those stay implicit
+    template <typename... Values>
+        requires (sizeof...(Values) == sizeof...(Keys)
+            && !(sizeof...(Values) == 1 && (std::is_same_v<std::remove_cvref_t<Values>, tmpl_frozen_map> && ...)))
+    constexpr tmpl_frozen_map(Values&&... values) : m_values{T(std::forward<Values>(values))...} {}
+
+    static constexpr size_type size() noexcept { return sizeof...(Keys); }
+    static constexpr bool contains(key_type key) noexcept { return set_type::contains(key); }
+    static constexpr size_type index_of(key_type key) noexcept { return set_type::index_of(key); }
+    static constexpr key_type key(size_type index) noexcept { return set_type::key(index); }
+
+    constexpr const T* find(key_type key) const noexcept {
+        const size_type index = set_type::index_of(key);
+        return index == set_type::npos ? nullptr : m_values + index;
+    }
+    constexpr T* find(key_type key) noexcept {
+        const size_type index = set_type::index_of(key);
+        return index == set_type::npos ? nullptr : m_values + index;
+    }
+
+    constexpr const T& at(key_type key) const {
+        if (const T* value = find(key)) return *value;
+        throw std::out_of_range("tmpl_frozen_map::at: key not found");
+    }
+    constexpr T& at(key_type key) {
+        if (T* value = find(key)) return *value;
+        throw std::out_of_range("tmpl_frozen_map::at: key not found");
+    }
+
+    // lookup of key known at compile time, no hashing
+    template <basic_tmpl_string Key>
+    constexpr const T& get() const noexcept {
+        constexpr size_type index = set_type::index_of(key_type(Key.data(), Key.size()));
+        static_assert(index != set_type::npos, "Key not found in tmpl_frozen_map");
+        return m_values[index];
+    }
+    template <basic_tmpl_string Key>
+    constexpr T& get() noexcept {
+        constexpr size_type index = set_type::index_of(key_type(Key.data(), Key.size()));
+        static_assert(index != set_type::npos, "Key not found in tmpl_frozen_map");
+        return m_values[index];
+    }
+
+    constexpr const T& value(size_type index) const noexcept { return m_values[index]; }
+    constexpr T& value(size_type index) noexcept { return m_values[index]; }
+
+private:
+    T m_values[sizeof...(Keys)];
+};
+
+#endif // TMPL_FROZEN_MAP_HPP
@@ -0,0 +1,277 @@
+/* C++20 and later, substring search with basic_tmpl_string needles prepared at compile time */
+/*
+  using error_tag = tmpl_searcher<"ERROR">;
+  size_t pos = error_tag::find(log);
+  size_t n   = error_tag::count(log);
+  error_tag::find_all(log, [](size_t pos) { ... });
+
+  using levels = tmpl_multi_searcher<"WARN", "ERROR", "FATAL">;
+  auto m = levels::find(log); // m.pos, m.index of needle
+
+SIMD filter (SSE2 16 or AVX2 32 positions per step):
+  candidates = (block[i] == needle.front()) & (block[i + n - 1] == needle.back())
+and every candidate is checked with memcmp of constant length.
+Tail and targets without SIMD use Horspool with skip table built at compile time.
+Matches of find_all and count do not overlap.
+*/
+#ifndef TMPL_SEARCH_HPP
+#define TMPL_SEARCH_HPP
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define TMPL_SEARCH_SIMD
+#endif
+
+#include "tmpl_string.hpp"
+
+namespace detail {
+#if defined(__AVX2__)
+    struct search_vec {
+        using type = __m256i;
+        static constexpr size_t width = 32;
+
+        static type splat(char c) noexcept { return _mm256_set1_epi8(c); }
+        // bit i is set if p[i] == first and p[i + last_offset] == last
+        static uint32_t candidates(const char* p, size_t last_offset, type first, type last) noexcept {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + last_offset));
+            const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+        }
+    };
+#elif defined(TMPL_SEARCH_SIMD)
+    struct search_vec {
+        using type = __m128i;
+        static constexpr size_t width = 16;
+
+        static type splat(char c) noexcept { return _mm_set1_epi8(c); }
+        static uint32_t candidates(const char* p, size_t last_offset, type first, type last) noexcept {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + last_offset));
+            const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last));
+            return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+        }
+    };
+#endif
+
+    inline unsigned search_ctz(uint32_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned out = 0;
+        while (!(mask & 1)) { mask >>= 1; out++; }
+        return out;
+#endif
+    }
+
+    template <basic_tmpl_string Needle>
+    struct search_needle {
+        static_assert(std::is_same_v<typename decltype(Needle)::value_type, char>,
+            "tmpl_searcher supports only char needles");
+        static_assert(Needle.size() > 0, "Needle of tmpl_searcher must not be empty");
+
+        static constexpr size_t size = Needle.size();
+        static constexpr char first = Needle.data()[0];
+        static constexpr char last  = Needle.data()[size - 1];
+
+        // Horspool shift for last byte of window
+        struct skip_table { size_t shift[256]; };
+        static constexpr skip_table skip = [] {
+            skip_table out {};
+            for (size_t c = 0; c < 256; c++) out.shift[c] = size;
+            for (size_t i = 0; i + 1 < size; i++)
+                out.shift[static_cast<unsigned char>(Needle.data()[i])] = size - 1 - i;
+            return out;
+        }();
+
+        static bool equal(const char* p) noexcept {
+            return std::memcmp(p, Needle.data(), size) == 0;
+        }
+
+        static size_t horspool(const char* data, size_t size_, size_t pos) noexcept {
+            if (size_ < size) return size_t(-1);
+            while (pos <= size_ - size) {
+                const char tail = data[pos + size - 1];
+                if (tail == last && equal(data + pos)) return pos;
+                pos += skip.shift[static_cast<unsigned char>(tail)];
+            }
+            return size_t(-1);
+        }
+    };
+}
+
+template <basic_tmpl_string Needle>
+class tmpl_searcher {
+    using needle_t = detail::search_needle<Needle>;
+
+public:
+    static constexpr size_t npos = size_t(-1);
+
+    static constexpr std::string_view needle() noexcept { return {Needle.data(), Needle.size()}; }
+    static constexpr size_t size() noexcept { return needle_t::size; }
+
+    // position of first match at or after 'pos', npos if not found
+    static size_t find(const void* data, size_t size, size_t pos = 0) noexcept {
+        const char* p = static_cast<const char*>(data);
+        if (pos > size || size - pos < needle_t::size) return npos;
+
+#ifdef TMPL_SEARCH_SIMD
+        using vec = detail::search_vec;
+        constexpr size_t last_offset = needle_t::size - 1;
+        const vec::type first = vec::splat(needle_t::first);
+        const vec::type last  = vec::splat(needle_t::last);
+
+        for (; pos + last_offset + vec::width <= size; pos += vec::width) {
+            uint32_t mask = vec::candidates(p + pos, last_offset, first, last);
+            while (mask) {
+                const size_t at = pos + detail::search_ctz(mask);
+                if (needle_t::size <= 2 || needle_t::equal(p + at)) return at;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        return needle_t::horspool(p, size, pos);
+    }
+    static size_t find(std::string_view haystack, size_t pos = 0) noexcept {
+        return find(haystack.data(), haystack.size(), pos);
+    }
+
+    // calls 'fn(pos)' for every match, returns count of matches
+    template <typename Fn>
+    static size_t find_all(const void* data, size_t size, Fn&& fn) {
+        size_t out = 0;
+        for (size_t pos = find(data, size); pos != npos; pos = find(data, size, pos + needle_t::size)) {
+            fn(pos);
+            out++;
+        }
+        return out;
+    }
+    template <typename Fn>
+    static size_t find_all(std::string_view haystack, Fn&& fn) {
+        return find_all(haystack.data(), haystack.size(), std::forward<Fn>(fn));
+    }
+
+    static size_t count(const void* data, size_t size) noexcept {
+        return find_all(data, size, [](size_t) noexcept {});
+    }
+    static size_t count(std::string_view haystack) noexcept {
+        return count(haystack.data(), haystack.size());
+    }
+};
+
+struct tmpl_search_match {
+    size_t pos;   // npos if not found
+    size_t index; // index of needle in template argument list
+    size_t size;  // size of matched needle
+
+    explicit operator bool() const noexcept { return pos != size_t(-1); }
+};
+
+template <basic_tmpl_string... Needles>
+class tmpl_multi_searcher {
+    static_assert(sizeof...(Needles) > 0, "tmpl_multi_searcher needs at least one needle");
+
+    static constexpr size_t sizes[] = { detail::search_needle<Needles>::size... };
+    static constexpr size_t max_size = [] {
+        size_t out = 0;
+        for (size_t s : sizes) out = s > out ? s : out;
+        return out;
+    }();
+    static constexpr size_t min_size = [] {
+        size_t out = size_t(-1);
+        for (size_t s : sizes) out = s < out ? s : out;
+        return out;
+    }();
+
+    struct first_table { bool used[256]; };
+    static constexpr first_table firsts = [] {
+        first_table out {};
+        ((out.used[static_cast<unsigned char>(detail::search_needle<Needles>::first)] = true), ...);
+        return out;
+    }();
+
+    // index of first needle matched at 'p' or npos, 'left' is count of bytes from 'p' to end
+    static size_t match_at(const char* p, size_t left) noexcept {
+        size_t index = 0, out = npos;
+        ((out == npos && detail::search_needle<Needles>::size <= left
+            && detail::search_needle<Needles>::equal(p) ? out = index : 0, index++), ...);
+        return out;
+    }
+
+    static tmpl_search_match make_match(size_t pos, size_t index) noexcept {
+        return { pos, index, index == npos ? 0 : sizes[index] };
+    }
+
+public:
+    static constexpr size_t npos = size_t(-1);
+
+    static constexpr size_t needle_count() noexcept { return sizeof...(Needles); }
+    static constexpr std::string_view needle(size_t index) noexcept {
+        constexpr std::string_view views[] = { std::string_view(Needles.data(), Needles.size())... };
+        return views[index];
+    }
+
+    // leftmost match at or after 'pos', ties are resolved to earlier needle
+    static tmpl_search_match find(const void* data, size_t size, size_t pos = 0) noexcept {
+        const char* p = static_cast<const char*>(data);
+        if (pos > size || size - pos < min_size) return make_match(npos, npos);
+
+#ifdef TMPL_SEARCH_SIMD
+        using vec = detail::search_vec;
+        const vec::type first[] = { vec::splat(detail::search_needle<Needles>::first)... };
+        const vec::type last[]  = { vec::splat(detail::search_needle<Needles>::last)... };
+
+        for (; pos + max_size - 1 + vec::width <= size; pos += vec::width) {
+            uint32_t mask = 0;
+            size_t k = 0;
+            ((mask |= vec::candidates(p + pos, detail::search_needle<Needles>::size - 1, first[k], last[k]), k++), ...);
+            while (mask) {
+                const size_t at = pos + detail::search_ctz(mask);
+                const size_t index = match_at(p + at, size - at);
+                if (index != npos) return make_match(at, index);
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; pos + min_size <= size; pos++) {
+            if (!firsts.used[static_cast<unsigned char>(p[pos])]) continue;
+            const size_t index = match_at(p + pos, size - pos);
+            if (index != npos) return make_match(pos, index);
+        }
+        return make_match(npos, npos);
+    }
+    static tmpl_search_match find(std::string_view haystack, size_t pos = 0) noexcept {
+        return find(haystack.data(), haystack.size(), pos);
+    }
+
+    // calls 'fn(match)' for every match, returns count of matches
+    template <typename Fn>
+    static size_t find_all(const void* data, size_t size, Fn&& fn) {
+        size_t out = 0;
+        for (tmpl_search_match m = find(data, size); m; m = find(data, size, m.pos + m.size)) {
+            fn(m);
+            out++;
+        }
+        return out;
+    }
+    template <typename Fn>
+    static size_t find_all(std::string_view haystack, Fn&& fn) {
+        return find_all(haystack.data(), haystack.size(), std::forward<Fn>(fn));
+    }
+
+    static size_t count(const void* data, size_t size) noexcept {
+        return find_all(data, size, [](const tmpl_search_match&) noexcept {});
+    }
+    static size_t count(std::string_view haystack) noexcept {
+        return count(haystack.data(), haystack.size());
+    }
+};
+
+#endif // TMPL_SEARCH_HPP
@@ -52,13 +52,20 @@ namespace detail {
         using os_t       = std::basic_ostream<CharT, Traits>;
         using ios_base_t = typename os_t::ios_base;
 
-        const CharT c = out.fill();
-        for (; n > 0; --n) {
-            const typename Traits::int_type put = out.rdbuf()->sputc(c);
-            if (Traits::eq_int_type(put, Traits::eof())) {
+        // padding is written by chunks, one sputn per 64 chars instead of sputc per char
+        constexpr std::streamsize chunk = 64;
+        CharT buffer[chunk];
+        const std::streamsize filled = n < chunk ? n : chunk;
+        for (std::streamsize i = 0; i < filled; i++)
+            buffer[i] = out.fill();
+
+        while (n > 0) {
+            const std::streamsize step = n < chunk ? n : chunk;
+            if (out.rdbuf()->sputn(buffer, step) != step) {
                 out.setstate(ios_base_t::badbit);
                 break;
             }
+            n -= step;
         }
     }
 
@@ -67,6 +74,17 @@ namespace detail {
         using os_t       = std::basic_ostream<CharT, Traits>;
         using ios_base_t = typename os_t::ios_base;
 
+        // fast path: no padding and nothing a sentry would do (tie flush, unitbuf flush)
+        if (out.width() <= n && out.good() && !out.tie() && !(out.flags() & ios_base_t::unitbuf)) {
+            try {
+                ostream_write(out, data, n);
+                out.width(0);
+            } catch (...) {
+                out.setstate(ios_base_t::badbit);
+            }
+            return out;
+        }
+
         typename os_t::sentry cerb(out);
         if (cerb) {
             try {
@@ -88,6 +106,30 @@ namespace detail {
 
         return out;
     }
+
+    struct tmpl_string_uninit_t { explicit constexpr tmpl_string_uninit_t() = default; };
+    constexpr tmpl_string_uninit_t tmpl_string_uninit {};
+
+    constexpr size_t tmpl_substr_size(size_t size, size_t pos, size_t len) noexcept {
+        return size - pos < len ? size - pos : len;
+    }
+
+    constexpr size_t tmpl_int_chars(long long value) noexcept {
+        unsigned long long mag = value < 0 ? 0ull - static_cast<unsigned long long>(value)
+                                           : static_cast<unsigned long long>(value);
+        size_t out = value < 0 ? 2 : 1;
+        while (mag >= 10) { mag /= 10; out++; }
+        return out;
+    }
+
+    template <typename CharT>
+    constexpr CharT tmpl_to_upper(CharT c) noexcept {
+        return c >= CharT('a') && c <= CharT('z') ? CharT(c - CharT('a') + CharT('A')) : c;
+    }
+    template <typename CharT>
+    constexpr CharT tmpl_to_lower(CharT c) noexcept {
+        return c >= CharT('A') && c <= CharT('Z') ? CharT(c - CharT('A') + CharT('a')) : c;
+    }
 }
 
 template <
@@ -108,18 +150,22 @@ template <
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
     using reverse_iterator       = const_reverse_iterator;
 
+    static constexpr size_type npos = size_type(-1);
+
     value_type content[N] {}; // null-terminated string
 
 public: // constructors
     constexpr basic_tmpl_string(const value_type (&str)[N]) noexcept {
         for (size_t i = 0; i < N; i++)
-            traits_type::assign(content[i], str[i]);
+            content[i] = str[i]; // traits_type::assign is constexpr only since C++17
     }
     template <typename... CharTs>
     constexpr basic_tmpl_string(CharTs&&... chars) noexcept : content{chars...} {
         static_assert(detail::conjunction<std::is_same<CharTs, value_type>...>::value, "All CharTs must be equal value_type");
         static_assert(sizeof...(chars) + 1 == N, "Count of chars not equal N - 1");
     }
+    // zero-filled string for building results of operations
+    constexpr explicit basic_tmpl_string(detail::tmpl_string_uninit_t) noexcept {}
 
     constexpr basic_tmpl_string() noexcept = delete;
     constexpr basic_tmpl_string(const basic_tmpl_string&) noexcept = default;
@@ -157,12 +203,106 @@ public: // convert
 #ifdef __cpp_lib_string_view
     constexpr operator std::basic_string_view<value_type, traits_type>() const noexcept { return {data(), size()}; }
 #endif
+    // copy size() chars without null, 'out' must have room for them, returns end of written
+    constexpr pointer write_to(pointer out) const noexcept {
+        for (size_t i = 0; i < size(); i++)
+            out[i] = content[i];
+        return out + size();
+    }
+    // any string with append(const CharT*, size), as std::basic_string
+    template <typename String>
+    String& append_to(String& out) const {
+        out.append(data(), size());
+        return out;
+    }
 
 public: // capacity
     constexpr size_type size() const noexcept { return N - 1; }
     constexpr size_type length() const noexcept { return size(); }
     constexpr bool empty() const noexcept { return begin() == end(); }
 
+public: // operations
+    template <size_t Pos, size_t Len = npos>
+    constexpr basic_tmpl_string<detail::tmpl_substr_size(N - 1, Pos, Len) + 1, value_type, traits_type>
+    substr() const noexcept {
+        static_assert(Pos <= N - 1, "Pos > size()");
+        basic_tmpl_string<detail::tmpl_substr_size(N - 1, Pos, Len) + 1, value_type, traits_type> out(detail::tmpl_string_uninit);
+        for (size_t i = 0; i < out.size(); i++)
+            out.content[i] = content[Pos + i];
+        return out;
+    }
+
+    constexpr basic_tmpl_string to_upper() const noexcept {
+        basic_tmpl_string out(detail::tmpl_string_uninit);
+        for (size_t i = 0; i < size(); i++)
+            out.content[i] = detail::tmpl_to_upper(content[i]);
+        return out;
+    }
+    constexpr basic_tmpl_string to_lower() const noexcept {
+        basic_tmpl_string out(detail::tmpl_string_uninit);
+        for (size_t i = 0; i < size(); i++)
+            out.content[i] = detail::tmpl_to_lower(content[i]);
+        return out;
+    }
+
+public: // search
+    constexpr size_type find(const_pointer str, size_type pos, size_type count) const noexcept {
+        if (count > size() || pos > size() - count) return npos;
+        for (size_type i = pos; i <= size() - count; i++) {
+            size_type j = 0;
+            while (j < count && traits_type::eq(content[i + j], str[j])) j++;
+            if (j == count) return i;
+        }
+        return npos;
+    }
+    template <size_t M>
+    constexpr size_type find(const basic_tmpl_string<M, value_type, traits_type>& str, size_type pos = 0) const noexcept {
+        return find(str.data(), pos, str.size());
+    }
+    template <size_t M>
+    constexpr size_type find(const value_type (&str)[M], size_type pos = 0) const noexcept {
+        return find(str, pos, M - 1);
+    }
+    constexpr size_type find(value_type ch, size_type pos = 0) const noexcept {
+        return find(&ch, pos, 1);
+    }
+
+    constexpr bool starts_with(const_pointer str, size_type count) const noexcept {
+        if (count > size()) return false;
+        for (size_type i = 0; i < count; i++)
+            if (!traits_type::eq(content[i], str[i])) return false;
+        return true;
+    }
+    template <size_t M>
+    constexpr bool starts_with(const basic_tmpl_string<M, value_type, traits_type>& str) const noexcept {
+        return starts_with(str.data(), str.size());
+    }
+    template <size_t M>
+    constexpr bool starts_with(const value_type (&str)[M]) const noexcept {
+        return starts_with(str, M - 1);
+    }
+    constexpr bool starts_with(value_type ch) const noexcept {
+        return !empty() && traits_type::eq(front(), ch);
+    }
+
+    constexpr bool ends_with(const_pointer str, size_type count) const noexcept {
+        if (count > size()) return false;
+        for (size_type i = 0; i < count; i++)
+            if (!traits_type::eq(content[size() - count + i], str[i])) return false;
+        return true;
+    }
+    template <size_t M>
+    constexpr bool ends_with(const basic_tmpl_string<M, value_type, traits_type>& str) const noexcept {
+        return ends_with(str.data(), str.size());
+    }
+    template <size_t M>
+    constexpr bool ends_with(const value_type (&str)[M]) const noexcept {
+        return ends_with(str, M - 1);
+    }
+    constexpr bool ends_with(value_type ch) const noexcept {
+        return !empty() && traits_type::eq(content[size() - 1], ch);
+    }
+
 public: // comparation
     template <size_t M>
     CEX_CXX17 int compare(const basic_tmpl_string<M, value_type, traits_type>& rhs) const noexcept {
@@ -199,6 +339,43 @@ std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>&
     return detail::ostream_insert(os, ts.data(), ts.size());
 }
 
+template <size_t N, size_t M, typename CharT, typename Traits>
+constexpr basic_tmpl_string<N + M - 1, CharT, Traits>
+operator+(const basic_tmpl_string<N, CharT, Traits>& lhs, const basic_tmpl_string<M, CharT, Traits>& rhs) noexcept {
+    basic_tmpl_string<N + M - 1, CharT, Traits> out(detail::tmpl_string_uninit);
+    for (size_t i = 0; i < N - 1; i++)
+        out.content[i] = lhs.content[i];
+    for (size_t i = 0; i < M - 1; i++)
+        out.content[N - 1 + i] = rhs.content[i];
+    return out;
+}
+template <size_t N, size_t M, typename CharT, typename Traits>
+constexpr basic_tmpl_string<N + M - 1, CharT, Traits>
+operator+(const basic_tmpl_string<N, CharT, Traits>& lhs, const CharT (&rhs)[M]) noexcept {
+    return lhs + basic_tmpl_string<M, CharT, Traits>(rhs);
+}
+template <size_t N, size_t M, typename CharT, typename Traits>
+constexpr basic_tmpl_string<N + M - 1, CharT, Traits>
+operator+(const CharT (&lhs)[N], const basic_tmpl_string<M, CharT, Traits>& rhs) noexcept {
+    return basic_tmpl_string<N, CharT, Traits>(lhs) + rhs;
+}
+
+// decimal representation of Value
+template <long long Value, typename CharT = char, typename Traits = std::char_traits<CharT>>
+constexpr basic_tmpl_string<detail::tmpl_int_chars(Value) + 1, CharT, Traits>
+to_tmpl_string() noexcept {
+    basic_tmpl_string<detail::tmpl_int_chars(Value) + 1, CharT, Traits> out(detail::tmpl_string_uninit);
+    unsigned long long mag = Value < 0 ? 0ull - static_cast<unsigned long long>(Value)
+                                       : static_cast<unsigned long long>(Value);
+    size_t pos = out.size();
+    do {
+        out.content[--pos] = static_cast<CharT>(CharT('0') + mag % 10);
+        mag /= 10;
+    } while (mag != 0);
+    if (Value < 0) out.content[0] = CharT('-');
+    return out;
+}
+
 #if defined(__GNUG__) && !defined(__clang__)
 namespace tmpl_string_literals {
     template <typename CharT, CharT... Chars>
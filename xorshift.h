@@ -45,6 +45,16 @@ uint64_t xorshift64s(xorshift64s_state * const state);
 
 #ifdef XORSHIFT_IMPLEMENTATION
 
+#ifdef SOH_INSTRUMENT
+#include "instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 #ifdef XORSHIFT_STATIC_STATE
 
 uint32_t xorshift32_state(uint32_t seed) {
@@ -71,6 +81,7 @@ uint32_t xorshift32(void) {
     x ^= x >> 17;
     x ^= x << 5;
     (void)xorshift32_state(x);
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return x;
 }
 
@@ -80,6 +91,7 @@ uint64_t xorshift64(void) {
     x ^= x >> 7;
     x ^= x << 17;
     (void)xorshift64_state(x);
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return x;
 }
 
@@ -89,6 +101,7 @@ uint64_t xorshift64s(void) {
     x ^= x << 25;
     x ^= x >> 27;
     (void)xorshift64s_state(x);
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return x * UINT64_C(2685821657736338717);
 }
 
@@ -99,6 +112,7 @@ uint32_t xorshift32(xorshift32_state * const state) {
     x ^= x << 13;
     x ^= x >> 17;
     x ^= x << 5;
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return state->state = x;
 }
 
@@ -107,6 +121,7 @@ uint64_t xorshift64(xorshift64_state * const state) {
     x ^= x << 13;
     x ^= x >> 7;
     x ^= x << 17;
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return state->state = x;
 }
 
@@ -116,6 +131,7 @@ uint64_t xorshift64s(xorshift64s_state * const state) {
     x ^= x << 25;
     x ^= x >> 27;
     state->state = x;
+    SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof x);
     return x * UINT64_C(2685821657736338717);
 }
 
@@ -11,6 +11,16 @@ C++11 and later
 #include <ostream>
 #include <istream>
 
+#ifdef SOH_INSTRUMENT
+#include "instrument.h"
+#endif
+#ifndef SOH_INSTR_BEGIN
+#define SOH_INSTR_BEGIN(scope, kind)
+#define SOH_INSTR_BYTES(scope, n)
+#define SOH_INSTR_END(scope)
+#define SOH_INSTR_ADD(kind, bytes)
+#endif
+
 class xorshift {
 public:
     using result_type = uint_fast64_t;
@@ -38,6 +48,7 @@ public:
 
     result_type operator()() {
         next_state();
+        SOH_INSTR_ADD(SOH_INSTR_XORSHIFT, sizeof m_state);
         return m_state *
             UINT64_C(2685821657736338717);
     }